@@ -0,0 +1,175 @@
+#include "aiplayer.h"
+
+AIPlayer::AIPlayer(Strategy strategy)
+    : strategy(strategy), currentMode(Random), lastHit(-1, -1), currentDirection(0),
+      rng(std::random_device{}()), timeBudget(5000), samplerThreads(0)
+{
+    directions = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+}
+
+void AIPlayer::reset(const std::vector<int>& fleet)
+{
+    currentMode = Random;
+    targetQueue.clear();
+    lastHit = {-1, -1};
+    currentDirection = 0;
+    model.reset(fleet);
+    model.setPrior(prior);
+    
+    if (strategy == BackgroundDensity && !background) {
+        background = std::make_unique<BackgroundTargeting>();
+    }
+    if (background) {
+        background->reset(fleet, prior);
+    }
+}
+
+std::pair<int, int> AIPlayer::makeMove(const BattleshipBoard& board)
+{
+    if (strategy == Density) {
+        return densityMove(board);
+    }
+    if (strategy == MonteCarlo) {
+        return monteCarloMove(board);
+    }
+    if (strategy == BackgroundDensity) {
+        return backgroundMove(board);
+    }
+    return huntTargetMove(board);
+}
+
+void AIPlayer::setSamplerThreads(int threads)
+{
+    samplerThreads = threads;
+    sampler.reset();
+}
+
+std::pair<int, int> AIPlayer::densityMove(const BattleshipBoard& board)
+{
+    model.compute(density);
+    int cell = DensityModel::bestCell(density, board.unshotCells(), rng);
+    if (cell == -1) {
+        return huntTargetMove(board);
+    }
+    return {cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE};
+}
+
+std::pair<int, int> AIPlayer::monteCarloMove(const BattleshipBoard& board)
+{
+    if (!sampler) {
+        sampler = std::make_unique<MonteCarloSampler>(samplerThreads);
+    }
+    int cell = sampler->search(model, timeBudget, rng());
+    if (cell == -1 || board.isShot(cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE)) {
+        return densityMove(board);
+    }
+    return {cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE};
+}
+
+std::pair<int, int> AIPlayer::backgroundMove(const BattleshipBoard& board)
+{
+    int cell = background ? background->bestMove() : -1;
+    if (cell == -1 || board.isShot(cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE)) {
+        return densityMove(board);
+    }
+    return {cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE};
+}
+
+BoardMask AIPlayer::makeSalvo(const BattleshipBoard& board, int count)
+{
+    BoardMask salvo;
+    BoardMask candidates = board.unshotCells();
+    DensityModel assumed = model;
+    for (int shot = 0; shot < count && candidates.any(); ++shot) {
+        assumed.compute(density);
+        int cell = DensityModel::bestCell(density, candidates, rng);
+        if (cell == -1) {
+            cell = candidates.nth(std::uniform_int_distribution<>(0, candidates.count() - 1)(rng));
+        }
+        salvo.set(cell);
+        candidates.reset(cell);
+        assumed.recordShot(cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE, false, false);
+    }
+    return salvo;
+}
+
+void AIPlayer::updateSalvo(const SalvoResult& salvo)
+{
+    for (int shot = 0; shot < salvo.count; ++shot) {
+        int cell = salvo.cells[shot];
+        updateResult(cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE, salvo.results[shot]);
+    }
+}
+
+std::pair<int, int> AIPlayer::huntTargetMove(const BattleshipBoard& board)
+{
+    while (!targetQueue.empty()) {
+        auto move = targetQueue.back();
+        targetQueue.pop_back();
+        if (isValidCell(move.first, move.second, board)) {
+            return move;
+        }
+    }
+    
+    if (currentMode == Target && lastHit.first != -1) {
+        for (auto& dir : directions) {
+            int newRow = lastHit.first + dir.first;
+            int newCol = lastHit.second + dir.second;
+            if (isValidCell(newRow, newCol, board)) {
+                return {newRow, newCol};
+            }
+        }
+
+        currentMode = Random;
+    }
+    
+    BoardMask availableMoves = board.unshotCells();
+    if (availableMoves.none()) {
+        return {-1, -1};
+    }
+    
+    BoardMask priorityMoves = availableMoves & BattleshipBoard::CHECKERBOARD_MASK;
+    const BoardMask& movesToChoose = priorityMoves.none() ? availableMoves : priorityMoves;
+    std::uniform_int_distribution<> dis(0, movesToChoose.count() - 1);
+    int cell = movesToChoose.nth(dis(rng));
+    return {cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE};
+}
+
+
+bool AIPlayer::isValidCell(int row, int col, const BattleshipBoard& board)
+{
+    return BattleshipBoard::inBounds(row, col) && !board.isShot(row, col);
+}
+
+
+void AIPlayer::updateResult(int row, int col, const ShotResult& result)
+{
+    bool hit = result.hit();
+    bool sunk = result.sunk();
+    model.recordShot(row, col, hit, sunk);
+    if (background) {
+        background->recordShot(row, col, hit, sunk);
+    }
+    
+    if (hit && !sunk) {
+        currentMode = Target;
+        lastHit = {row, col};
+        addAdjacentCells(row, col);
+    } else if (sunk) {
+        currentMode = Random;
+        targetQueue.clear();
+        lastHit = {-1, -1};
+    }
+}
+
+
+void AIPlayer::addAdjacentCells(int row, int col)
+{
+    for (auto& dir : directions) {
+        int newRow = row + dir.first;
+        int newCol = col + dir.second;
+        if (BattleshipBoard::inBounds(newRow, newCol)) {
+            targetQueue.push_back({newRow, newCol});
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef AIPLAYER_H
+#define AIPLAYER_H
+
+#include "battleshipboard.h"
+#include "densitymodel.h"
+#include "montecarlosampler.h"
+#include "incrementaldensity.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <random>
+
+class AIPlayer
+{
+public:
+    // BackgroundDensity начинает работать со следующего reset()
+    enum Strategy { HuntTarget, Density, MonteCarlo, BackgroundDensity };
+
+    AIPlayer(Strategy strategy = Density);
+    void reset(const std::vector<int>& fleet);
+    void setStrategy(Strategy newStrategy) { strategy = newStrategy; }
+    Strategy getStrategy() const { return strategy; }
+    void setSeed(std::uint32_t seed) { rng.seed(seed); }
+    // Параметры стратегии MonteCarlo: время на ход и число потоков (0 - по числу ядер)
+    void setTimeBudget(std::chrono::microseconds budget) { timeBudget = budget; }
+    void setSamplerThreads(int threads);
+    // Где люди обычно ставят корабли (PlacementPrior::weights()); действует со следующего reset().
+    // MonteCarlo выбирает положения равномерно и эти веса не учитывает
+    void setPlacementPrior(std::shared_ptr<const PlacementWeights> weights) { prior = std::move(weights); }
+    std::pair<int, int> makeMove(const BattleshipBoard& board);
+    void updateResult(int row, int col, const ShotResult& result);
+    // Залп из count клеток при любой стратегии выбирается по плотности: каждая
+    // следующая клетка - лучшая при условии, что предыдущие промахнулись
+    BoardMask makeSalvo(const BattleshipBoard& board, int count);
+    void updateSalvo(const SalvoResult& salvo);
+    
+private:
+    enum Mode { Random, Hunt, Target };
+    Strategy strategy;
+    Mode currentMode;
+    std::vector<std::pair<int, int>> targetQueue;
+    std::pair<int, int> lastHit;
+    std::vector<std::pair<int, int>> directions;
+    int currentDirection;
+    std::mt19937 rng;
+    DensityModel model;
+    DensityModel::Grid density;
+    std::unique_ptr<MonteCarloSampler> sampler;
+    std::unique_ptr<BackgroundTargeting> background;
+    std::shared_ptr<const PlacementWeights> prior;
+    std::chrono::microseconds timeBudget;
+    int samplerThreads;
+    
+    std::pair<int, int> huntTargetMove(const BattleshipBoard& board);
+    std::pair<int, int> densityMove(const BattleshipBoard& board);
+    std::pair<int, int> monteCarloMove(const BattleshipBoard& board);
+    std::pair<int, int> backgroundMove(const BattleshipBoard& board);
+    void addAdjacentCells(int row, int col);
+    bool isValidCell(int row, int col, const BattleshipBoard& board);
+};
+
+#endif
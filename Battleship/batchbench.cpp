@@ -0,0 +1,148 @@
+// Партии в ногу против партий по одной: та же стратегия BatchSimulator::candidates,
+// сначала на BattleshipBoard по одной партии, потом в BatchSimulator с каждым ядром
+// battleship_batch [--games N] [--lanes L] [--seed S]
+// Перед замером выстрелы всех ядер сверяются с BattleshipBoard::attack
+
+#include "batchsimulator.h"
+#include "battleshipboard.h"
+#include "fleetgenerator.h"
+#include "standardfleet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::vector<int> STANDARD_FLEET = StandardFleet::fleet();
+
+double elapsedSeconds(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+BatchSimulator::Stats playOneByOne(std::mt19937_64& rng, std::uint64_t total)
+{
+    BatchSimulator::Stats stats;
+    FleetGenerator generator(STANDARD_FLEET);
+    BattleshipBoard board;
+    for (std::uint64_t game = 0; game < total; ++game) {
+        if (!generator.generate(rng, board)) {
+            break;
+        }
+        BoardMask sunk;
+        while (!board.allSunk()) {
+            BoardMask options = BatchSimulator::candidates(board.hitCells(), board.missCells(), sunk);
+            if (options.none()) break;
+            int cell = BatchSimulator::pickCell(options, static_cast<std::uint32_t>(rng()));
+            ShotResult result = board.attack(cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE);
+            if (result.sunk()) {
+                sunk |= board.shipCells(result.shipId);
+            }
+            stats.shots++;
+        }
+        stats.games++;
+    }
+    return stats;
+}
+
+// Каждая ячейка повторяется на своём BattleshipBoard; число расхождений в итогах выстрелов
+int verify(BatchSimulator::Kernel kernel, int lanes, std::uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    FleetGenerator generator(STANDARD_FLEET);
+    BatchSimulator batch(STANDARD_FLEET, lanes);
+    batch.setKernel(kernel);
+    std::vector<BattleshipBoard> boards(lanes);
+    FleetGenerator::Layout layout;
+    for (int game = 0; game < lanes; ++game) {
+        generator.generate(rng, layout);
+        batch.startGame(game, layout);
+        for (size_t shipId = 0; shipId < STANDARD_FLEET.size(); ++shipId) {
+            const ShipPlacement& placement = *layout[shipId];
+            boards[game].placeShip(static_cast<int>(shipId), placement.row, placement.col,
+                                   placement.cells.count(), placement.horizontal);
+        }
+    }
+
+    int mismatches = 0;
+    std::vector<char> wasActive(lanes, 1);
+    for (int left = lanes; left > 0;) {
+        left = batch.step(rng);
+        for (int game = 0; game < lanes; ++game) {
+            if (!wasActive[game]) continue;
+            int cell = batch.lastCell(game);
+            ShotResult expected = boards[game].attack(cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE);
+            ShotResult actual = batch.lastResult(game);
+            if (expected.outcome != actual.outcome || expected.shipId != actual.shipId) {
+                mismatches++;
+            }
+            wasActive[game] = batch.active(game);
+        }
+    }
+    return mismatches;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::uint64_t games = 200000;
+    int lanes = BatchSimulator::DEFAULT_GAMES;
+    std::uint64_t seed = std::random_device{}();
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--games") && hasValue) {
+            games = std::max<std::uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (!std::strcmp(argv[i], "--lanes") && hasValue) {
+            lanes = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--games N] [--lanes L] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const char* kernelNames[] = {"scalar", "sse4.1", "avx2"};
+    BatchSimulator::Kernel best = BatchSimulator::bestKernel();
+    std::printf("games:  %llu, lanes: %d, seed: %llu, best kernel: %s\n",
+                static_cast<unsigned long long>(games), lanes,
+                static_cast<unsigned long long>(seed), kernelNames[best]);
+
+    for (int kernel = BatchSimulator::Scalar; kernel <= best; ++kernel) {
+        int mismatches = verify(static_cast<BatchSimulator::Kernel>(kernel), lanes, seed);
+        if (mismatches > 0) {
+            std::fprintf(stderr, "%s: %d shots differ from BattleshipBoard::attack\n",
+                         kernelNames[kernel], mismatches);
+            return 1;
+        }
+    }
+
+    std::printf("%-16s %12s %12s %10s\n", "path", "games/s", "shots/game", "speedup");
+    std::mt19937_64 rng(seed);
+    auto start = Clock::now();
+    BatchSimulator::Stats single = playOneByOne(rng, games);
+    double baseline = single.games / elapsedSeconds(start);
+    std::printf("%-16s %12.0f %12.2f %9.2fx\n", "one by one", baseline,
+                double(single.shots) / single.games, 1.0);
+
+    for (int kernel = BatchSimulator::Scalar; kernel <= best; ++kernel) {
+        BatchSimulator batch(STANDARD_FLEET, lanes);
+        batch.setKernel(static_cast<BatchSimulator::Kernel>(kernel));
+        rng.seed(seed);
+        start = Clock::now();
+        BatchSimulator::Stats stats = batch.run(rng, games);
+        double rate = stats.games / elapsedSeconds(start);
+        std::printf("batch %-10s %12.0f %12.2f %9.2fx\n", kernelNames[kernel], rate,
+                    double(stats.shots) / stats.games, rate / baseline);
+    }
+    return 0;
+}
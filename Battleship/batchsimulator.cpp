@@ -0,0 +1,523 @@
+#include "batchsimulator.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+enum StepFlags : std::uint8_t { ALREADY_SHOT = 1, HIT = 2, SUNK = 4 };
+
+// Исход выстрела по флагам шага; последнее потопление превращает Sunk в FleetDestroyed
+constexpr std::uint8_t STEP_OUTCOMES[8] = {
+    ShotResult::Miss, ShotResult::AlreadyShot, ShotResult::Hit, ShotResult::AlreadyShot,
+    ShotResult::Miss, ShotResult::AlreadyShot, ShotResult::Sunk, ShotResult::AlreadyShot};
+
+constexpr BoardMask NOT_LAST_COL = BoardGeometry::mask(2);
+constexpr BoardMask NOT_FIRST_COL = BoardGeometry::mask(3);
+
+BoardMask leftOf(const BoardMask& mask) { return (mask & NOT_FIRST_COL).shifted(-1); }
+BoardMask rightOf(const BoardMask& mask) { return (mask & NOT_LAST_COL).shifted(1); }
+BoardMask above(const BoardMask& mask) { return mask.shifted(-BattleshipBoard::SIZE); }
+BoardMask below(const BoardMask& mask) { return mask.shifted(BattleshipBoard::SIZE) & BattleshipBoard::FULL_MASK; }
+
+// preferred, если она не пуста, иначе fallback - без ветвлений, чтобы цикл по партиям векторизовался
+BoardMask unlessEmpty(const BoardMask& preferred, const BoardMask& fallback)
+{
+    std::uint64_t keep = std::uint64_t(0) - std::uint64_t(preferred.any());
+    return {(preferred.lo & keep) | (fallback.lo & ~keep), (preferred.hi & keep) | (fallback.hi & ~keep)};
+}
+
+#if defined(__GNUC__)
+#define BATCH_INLINE inline __attribute__((always_inline))
+#else
+#define BATCH_INLINE inline
+#endif
+
+BATCH_INLINE BoardMask aimMask(const BoardMask& hits, const BoardMask& misses, const BoardMask& sunk)
+{
+    BoardMask open = BattleshipBoard::FULL_MASK & ~(hits | misses) & ~BattleshipBoard::neighbourhood(sunk);
+    BoardMask wounded = hits & ~sunk;
+    // Два соседних попадания задают направление корабля
+    BoardMask rowPairs = wounded & (leftOf(wounded) | rightOf(wounded));
+    BoardMask colPairs = wounded & (above(wounded) | below(wounded));
+    BoardMask along = (leftOf(rowPairs) | rightOf(rowPairs) | above(colPairs) | below(colPairs)) & open;
+    BoardMask around = (leftOf(wounded) | rightOf(wounded) | above(wounded) | below(wounded)) & open;
+    BoardMask parity = open & BattleshipBoard::CHECKERBOARD_MASK;
+    return unlessEmpty(along, unlessEmpty(around, unlessEmpty(parity, open)));
+}
+
+// Маски candidates() для партий [0, count) из массивов состояния
+BATCH_INLINE void aimLanes(const std::uint64_t* hitsLo, const std::uint64_t* hitsHi,
+                           const std::uint64_t* missesLo, const std::uint64_t* missesHi,
+                           const std::uint64_t* sunkLo, const std::uint64_t* sunkHi,
+                           std::uint64_t* optionsLo, std::uint64_t* optionsHi, int count)
+{
+    for (int game = 0; game < count; ++game) {
+        BoardMask options = aimMask(BoardMask(hitsLo[game], hitsHi[game]),
+                                    BoardMask(missesLo[game], missesHi[game]),
+                                    BoardMask(sunkLo[game], sunkHi[game]));
+        optionsLo[game] = options.lo;
+        optionsHi[game] = options.hi;
+    }
+}
+
+#ifdef BATCH_SIMD
+
+#define AVX2_INLINE inline __attribute__((target("avx2"), always_inline))
+
+// Маски четырёх партий: младшие и старшие 64 бита поля
+struct Masks4 {
+    __m256i lo, hi;
+};
+
+AVX2_INLINE Masks4 operator&(const Masks4& a, const Masks4& b)
+{
+    return {_mm256_and_si256(a.lo, b.lo), _mm256_and_si256(a.hi, b.hi)};
+}
+
+AVX2_INLINE Masks4 operator|(const Masks4& a, const Masks4& b)
+{
+    return {_mm256_or_si256(a.lo, b.lo), _mm256_or_si256(a.hi, b.hi)};
+}
+
+// a & ~b
+AVX2_INLINE Masks4 without(const Masks4& a, const Masks4& b)
+{
+    return {_mm256_andnot_si256(b.lo, a.lo), _mm256_andnot_si256(b.hi, a.hi)};
+}
+
+AVX2_INLINE Masks4 load(const std::uint64_t* lo, const std::uint64_t* hi)
+{
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi))};
+}
+
+AVX2_INLINE Masks4 broadcast(const BoardMask& mask)
+{
+    return {_mm256_set1_epi64x(static_cast<long long>(mask.lo)), _mm256_set1_epi64x(static_cast<long long>(mask.hi))};
+}
+
+// BoardMask::shifted для 0 < shift < 64 к старшим и к младшим индексам
+template <int shift>
+AVX2_INLINE Masks4 shiftedUp(const Masks4& m)
+{
+    return {_mm256_slli_epi64(m.lo, shift),
+            _mm256_or_si256(_mm256_slli_epi64(m.hi, shift), _mm256_srli_epi64(m.lo, 64 - shift))};
+}
+
+template <int shift>
+AVX2_INLINE Masks4 shiftedDown(const Masks4& m)
+{
+    return {_mm256_or_si256(_mm256_srli_epi64(m.lo, shift), _mm256_slli_epi64(m.hi, 64 - shift)),
+            _mm256_srli_epi64(m.hi, shift)};
+}
+
+AVX2_INLINE Masks4 unlessEmpty(const Masks4& preferred, const Masks4& fallback)
+{
+    __m256i empty = _mm256_cmpeq_epi64(_mm256_or_si256(preferred.lo, preferred.hi), _mm256_setzero_si256());
+    return {_mm256_blendv_epi8(preferred.lo, fallback.lo, empty),
+            _mm256_blendv_epi8(preferred.hi, fallback.hi, empty)};
+}
+
+// aimMask для четырёх партий сразу
+__attribute__((target("avx2"))) void aimLanesAvx2(const std::uint64_t* hitsLo, const std::uint64_t* hitsHi,
+                                                  const std::uint64_t* missesLo, const std::uint64_t* missesHi,
+                                                  const std::uint64_t* sunkLo, const std::uint64_t* sunkHi,
+                                                  std::uint64_t* optionsLo, std::uint64_t* optionsHi, int count)
+{
+    const int size = BattleshipBoard::SIZE;
+    const Masks4 full = broadcast(BattleshipBoard::FULL_MASK);
+    const Masks4 checkerboard = broadcast(BattleshipBoard::CHECKERBOARD_MASK);
+    const Masks4 notFirstCol = broadcast(NOT_FIRST_COL);
+    const Masks4 notLastCol = broadcast(NOT_LAST_COL);
+    for (int game = 0; game < count; game += 4) {
+        Masks4 hits = load(hitsLo + game, hitsHi + game);
+        Masks4 misses = load(missesLo + game, missesHi + game);
+        Masks4 sunk = load(sunkLo + game, sunkHi + game);
+
+        Masks4 sunkRow = sunk | shiftedUp<1>(sunk & notLastCol) | shiftedDown<1>(sunk & notFirstCol);
+        Masks4 halo = sunkRow | shiftedUp<size>(sunkRow) | shiftedDown<size>(sunkRow);
+        Masks4 open = without(full, hits | misses | halo);
+        Masks4 wounded = without(hits, sunk);
+
+        Masks4 woundedLeft = shiftedDown<1>(wounded & notFirstCol);
+        Masks4 woundedRight = shiftedUp<1>(wounded & notLastCol);
+        Masks4 woundedAbove = shiftedDown<size>(wounded);
+        Masks4 woundedBelow = shiftedUp<size>(wounded);
+        Masks4 rowPairs = wounded & (woundedLeft | woundedRight);
+        Masks4 colPairs = wounded & (woundedAbove | woundedBelow);
+        Masks4 along = (shiftedDown<1>(rowPairs & notFirstCol) | shiftedUp<1>(rowPairs & notLastCol) |
+                        shiftedDown<size>(colPairs) | shiftedUp<size>(colPairs)) & open;
+        Masks4 around = (woundedLeft | woundedRight | woundedAbove | woundedBelow) & open;
+        Masks4 parity = open & checkerboard;
+        Masks4 options = unlessEmpty(along, unlessEmpty(around, unlessEmpty(parity, open)));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(optionsLo + game), options.lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(optionsHi + game), options.hi);
+    }
+}
+
+#endif
+
+}
+
+BatchSimulator::BatchSimulator(const std::vector<int>& fleet, int games)
+    : fleet(fleet), generator(fleet), games(games < 1 ? 1 : games),
+      stride((this->games + 3) & ~3), activeKernel(bestKernel()),
+      occupiedLo(stride), occupiedHi(stride), hitsLo(stride), hitsHi(stride),
+      missesLo(stride), missesHi(stride), sunkLo(stride), sunkHi(stride),
+      shotLo(stride), shotHi(stride), optionsLo(stride), optionsHi(stride),
+      shipLo(BattleshipBoard::MAX_SHIPS * stride), shipHi(BattleshipBoard::MAX_SHIPS * stride),
+      draws(stride), flags(stride), shipIds(stride, -1),
+      running(stride), afloat(stride), outcomes(stride, ShotResult::Miss), cells(stride), shots(stride)
+{
+    if (this->fleet.size() > static_cast<size_t>(BattleshipBoard::MAX_SHIPS)) {
+        this->fleet.resize(BattleshipBoard::MAX_SHIPS);
+    }
+}
+
+BatchSimulator::Kernel BatchSimulator::bestKernel()
+{
+#ifdef BATCH_SIMD
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2")) return Avx2;
+    if (__builtin_cpu_supports("sse4.1")) return Sse41;
+#endif
+    return Scalar;
+}
+
+void BatchSimulator::setKernel(Kernel requested)
+{
+    Kernel best = bestKernel();
+    activeKernel = requested > best ? best : requested;
+}
+
+void BatchSimulator::startGame(int game, const FleetGenerator::Layout& layout)
+{
+    BoardMask occupied;
+    for (int shipId = 0; shipId < BattleshipBoard::MAX_SHIPS; ++shipId) {
+        BoardMask ship = shipId < static_cast<int>(fleet.size()) ? layout[shipId]->cells : BoardMask();
+        shipLo[shipId * stride + game] = ship.lo;
+        shipHi[shipId * stride + game] = ship.hi;
+        occupied |= ship;
+    }
+    occupiedLo[game] = occupied.lo;
+    occupiedHi[game] = occupied.hi;
+    hitsLo[game] = hitsHi[game] = 0;
+    missesLo[game] = missesHi[game] = 0;
+    sunkLo[game] = sunkHi[game] = 0;
+    shotLo[game] = shotHi[game] = 0;
+    afloat[game] = static_cast<std::uint8_t>(fleet.size());
+    running[game] = 1;
+    shots[game] = 0;
+    cells[game] = 0;
+    outcomes[game] = ShotResult::Miss;
+    shipIds[game] = -1;
+}
+
+ShotResult BatchSimulator::lastResult(int game) const
+{
+    return {static_cast<ShotResult::Outcome>(outcomes[game]), shipIds[game]};
+}
+
+BoardMask BatchSimulator::candidates(const BoardMask& hits, const BoardMask& misses, const BoardMask& sunk)
+{
+    return aimMask(hits, misses, sunk);
+}
+
+int BatchSimulator::pickCell(const BoardMask& options, std::uint32_t random)
+{
+    // Умножение со сдвигом вместо деления: смещение порядка count / 2^32
+    std::uint32_t count = static_cast<std::uint32_t>(options.count());
+    return options.nth(static_cast<int>((std::uint64_t(random) * count) >> 32));
+}
+
+void BatchSimulator::aim()
+{
+#ifdef BATCH_SIMD
+    if (activeKernel == Avx2) {
+        aimLanesAvx2(hitsLo.data(), hitsHi.data(), missesLo.data(), missesHi.data(),
+                     sunkLo.data(), sunkHi.data(), optionsLo.data(), optionsHi.data(), stride);
+        return;
+    }
+#endif
+    aimLanes(hitsLo.data(), hitsHi.data(), missesLo.data(), missesHi.data(),
+             sunkLo.data(), sunkHi.data(), optionsLo.data(), optionsHi.data(), stride);
+}
+
+int BatchSimulator::step(std::mt19937_64& rng)
+{
+    // Маски кандидатов считаются сразу для всех партий, случайный выбор клетки - у каждой свой;
+    // одного 64-битного числа хватает на две партии
+    aim();
+    for (int game = 0; game < games; game += 2) {
+        std::uint64_t random = rng();
+        draws[game] = static_cast<std::uint32_t>(random);
+        draws[game + 1] = static_cast<std::uint32_t>(random >> 32);
+    }
+
+    switch (activeKernel) {
+    case Avx2: pickBmi2(); resolveAvx2(); break;
+    case Sse41: pick(); resolveSse41(); break;
+    default: pick(); resolveScalar(); break;
+    }
+
+    // Итоги без ветвлений: исход партии на каждом шаге непредсказуем
+    int left = 0;
+    for (int game = 0; game < games; ++game) {
+        std::uint8_t live = running[game];
+        std::uint8_t flag = flags[game];
+        std::uint8_t sunk = ((flag & SUNK) != 0) & live;
+        afloat[game] -= sunk;
+        int outcome = STEP_OUTCOMES[flag & 7] + (sunk & (afloat[game] == 0));
+        outcomes[game] = static_cast<std::uint8_t>(live ? outcome : outcomes[game]);
+        shots[game] += live;
+        running[game] = live & (outcome != ShotResult::FleetDestroyed);
+        left += running[game];
+    }
+    return left;
+}
+
+void BatchSimulator::pick()
+{
+    for (int game = 0; game < games; ++game) {
+        shotLo[game] = shotHi[game] = 0;
+        if (!running[game]) continue;
+
+        BoardMask options(optionsLo[game], optionsHi[game]);
+        if (options.none()) {
+            running[game] = 0;
+            continue;
+        }
+        int cell = pickCell(options, draws[game]);
+        BoardMask shot = BoardMask::bit(cell);
+        cells[game] = static_cast<std::uint8_t>(cell);
+        shotLo[game] = shot.lo;
+        shotHi[game] = shot.hi;
+    }
+}
+
+BatchSimulator::Stats BatchSimulator::run(std::mt19937_64& rng, std::uint64_t total)
+{
+    Stats stats;
+    std::uint64_t started = 0;
+    FleetGenerator::Layout layout;
+    for (int game = 0; game < games; ++game) {
+        running[game] = 0;
+        shots[game] = 0;
+        if (started < total && generator.generate(rng, layout)) {
+            startGame(game, layout);
+            started++;
+        }
+    }
+
+    while (stats.games < started) {
+        step(rng);
+        for (int game = 0; game < games; ++game) {
+            if (running[game] || shots[game] == 0) continue;
+            stats.games++;
+            stats.shots += shots[game];
+            shots[game] = 0;
+            if (started < total && generator.generate(rng, layout)) {
+                startGame(game, layout);
+                started++;
+            }
+        }
+    }
+    return stats;
+}
+
+void BatchSimulator::resolveScalar()
+{
+    const int shipCount = static_cast<int>(fleet.size());
+    for (int game = 0; game < stride; ++game) {
+        std::uint64_t lo = shotLo[game];
+        std::uint64_t hi = shotHi[game];
+        bool already = ((lo & (hitsLo[game] | missesLo[game])) | (hi & (hitsHi[game] | missesHi[game]))) != 0;
+        bool hit = ((lo & occupiedLo[game]) | (hi & occupiedHi[game])) != 0;
+        hitsLo[game] |= lo & occupiedLo[game];
+        hitsHi[game] |= hi & occupiedHi[game];
+        missesLo[game] |= lo & ~occupiedLo[game];
+        missesHi[game] |= hi & ~occupiedHi[game];
+
+        int shipId = -1;
+        bool sunk = false;
+        for (int ship = 0; ship < shipCount; ++ship) {
+            std::uint64_t cellsLo = shipLo[ship * stride + game];
+            std::uint64_t cellsHi = shipHi[ship * stride + game];
+            if (((cellsLo & lo) | (cellsHi & hi)) == 0) continue;
+            shipId = ship;
+            if (!already && ((cellsLo & ~hitsLo[game]) | (cellsHi & ~hitsHi[game])) == 0) {
+                sunk = true;
+                sunkLo[game] |= cellsLo;
+                sunkHi[game] |= cellsHi;
+            }
+        }
+        flags[game] = (already ? ALREADY_SHOT : 0) | (hit ? HIT : 0) | (sunk ? SUNK : 0);
+        shipIds[game] = static_cast<std::int8_t>(shipId);
+    }
+}
+
+#ifdef BATCH_SIMD
+
+// Те же шаги, что в resolveScalar, для 2 партий в регистре; маски сравнений - по 64 бита на партию
+__attribute__((target("sse4.1"))) void BatchSimulator::resolveSse41()
+{
+    const int shipCount = static_cast<int>(fleet.size());
+    const __m128i zero = _mm_setzero_si128();
+    for (int game = 0; game < stride; game += 2) {
+        auto at = [game](std::vector<std::uint64_t>& v) { return reinterpret_cast<__m128i*>(v.data() + game); };
+        __m128i lo = _mm_loadu_si128(at(shotLo));
+        __m128i hi = _mm_loadu_si128(at(shotHi));
+        __m128i occLo = _mm_loadu_si128(at(occupiedLo));
+        __m128i occHi = _mm_loadu_si128(at(occupiedHi));
+        __m128i oldHitsLo = _mm_loadu_si128(at(hitsLo));
+        __m128i oldHitsHi = _mm_loadu_si128(at(hitsHi));
+        __m128i oldMissLo = _mm_loadu_si128(at(missesLo));
+        __m128i oldMissHi = _mm_loadu_si128(at(missesHi));
+
+        __m128i shotBefore = _mm_or_si128(_mm_and_si128(lo, _mm_or_si128(oldHitsLo, oldMissLo)),
+                                          _mm_and_si128(hi, _mm_or_si128(oldHitsHi, oldMissHi)));
+        __m128i fresh = _mm_cmpeq_epi64(shotBefore, zero);
+        __m128i hitLo = _mm_and_si128(lo, occLo);
+        __m128i hitHi = _mm_and_si128(hi, occHi);
+        __m128i miss = _mm_cmpeq_epi64(_mm_or_si128(hitLo, hitHi), zero);
+        __m128i newHitsLo = _mm_or_si128(oldHitsLo, hitLo);
+        __m128i newHitsHi = _mm_or_si128(oldHitsHi, hitHi);
+        _mm_storeu_si128(at(hitsLo), newHitsLo);
+        _mm_storeu_si128(at(hitsHi), newHitsHi);
+        _mm_storeu_si128(at(missesLo), _mm_or_si128(oldMissLo, _mm_andnot_si128(occLo, lo)));
+        _mm_storeu_si128(at(missesHi), _mm_or_si128(oldMissHi, _mm_andnot_si128(occHi, hi)));
+
+        __m128i sunkLoV = _mm_loadu_si128(at(sunkLo));
+        __m128i sunkHiV = _mm_loadu_si128(at(sunkHi));
+        __m128i sunkAny = zero;
+        __m128i ids = _mm_set1_epi64x(-1);
+        for (int ship = 0; ship < shipCount; ++ship) {
+            __m128i cellsLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shipLo.data() + ship * stride + game));
+            __m128i cellsHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shipHi.data() + ship * stride + game));
+            __m128i onShip = _mm_cmpeq_epi64(_mm_or_si128(_mm_and_si128(cellsLo, lo), _mm_and_si128(cellsHi, hi)), zero);
+            onShip = _mm_xor_si128(onShip, _mm_cmpeq_epi64(zero, zero));
+            __m128i whole = _mm_cmpeq_epi64(_mm_or_si128(_mm_andnot_si128(newHitsLo, cellsLo),
+                                                         _mm_andnot_si128(newHitsHi, cellsHi)), zero);
+            __m128i sunkNow = _mm_and_si128(_mm_and_si128(onShip, whole), fresh);
+            ids = _mm_blendv_epi8(ids, _mm_set1_epi64x(ship), onShip);
+            sunkAny = _mm_or_si128(sunkAny, sunkNow);
+            sunkLoV = _mm_or_si128(sunkLoV, _mm_and_si128(cellsLo, sunkNow));
+            sunkHiV = _mm_or_si128(sunkHiV, _mm_and_si128(cellsHi, sunkNow));
+        }
+        _mm_storeu_si128(at(sunkLo), sunkLoV);
+        _mm_storeu_si128(at(sunkHi), sunkHiV);
+
+        int freshBits = _mm_movemask_pd(_mm_castsi128_pd(fresh));
+        int missBits = _mm_movemask_pd(_mm_castsi128_pd(miss));
+        int sunkBits = _mm_movemask_pd(_mm_castsi128_pd(sunkAny));
+        alignas(16) std::int64_t id[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(id), ids);
+        for (int lane = 0; lane < 2; ++lane) {
+            flags[game + lane] = ((freshBits >> lane) & 1 ? 0 : ALREADY_SHOT) |
+                                 ((missBits >> lane) & 1 ? 0 : HIT) |
+                                 ((sunkBits >> lane) & 1 ? SUNK : 0);
+            shipIds[game + lane] = static_cast<std::int8_t>(id[lane]);
+        }
+    }
+}
+
+__attribute__((target("avx2"))) void BatchSimulator::resolveAvx2()
+{
+    const int shipCount = static_cast<int>(fleet.size());
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_cmpeq_epi64(zero, zero);
+    for (int game = 0; game < stride; game += 4) {
+        auto at = [game](std::vector<std::uint64_t>& v) { return reinterpret_cast<__m256i*>(v.data() + game); };
+        __m256i lo = _mm256_loadu_si256(at(shotLo));
+        __m256i hi = _mm256_loadu_si256(at(shotHi));
+        __m256i occLo = _mm256_loadu_si256(at(occupiedLo));
+        __m256i occHi = _mm256_loadu_si256(at(occupiedHi));
+        __m256i oldHitsLo = _mm256_loadu_si256(at(hitsLo));
+        __m256i oldHitsHi = _mm256_loadu_si256(at(hitsHi));
+        __m256i oldMissLo = _mm256_loadu_si256(at(missesLo));
+        __m256i oldMissHi = _mm256_loadu_si256(at(missesHi));
+
+        __m256i shotBefore = _mm256_or_si256(_mm256_and_si256(lo, _mm256_or_si256(oldHitsLo, oldMissLo)),
+                                             _mm256_and_si256(hi, _mm256_or_si256(oldHitsHi, oldMissHi)));
+        __m256i fresh = _mm256_cmpeq_epi64(shotBefore, zero);
+        __m256i hitLo = _mm256_and_si256(lo, occLo);
+        __m256i hitHi = _mm256_and_si256(hi, occHi);
+        __m256i miss = _mm256_cmpeq_epi64(_mm256_or_si256(hitLo, hitHi), zero);
+        __m256i newHitsLo = _mm256_or_si256(oldHitsLo, hitLo);
+        __m256i newHitsHi = _mm256_or_si256(oldHitsHi, hitHi);
+        _mm256_storeu_si256(at(hitsLo), newHitsLo);
+        _mm256_storeu_si256(at(hitsHi), newHitsHi);
+        _mm256_storeu_si256(at(missesLo), _mm256_or_si256(oldMissLo, _mm256_andnot_si256(occLo, lo)));
+        _mm256_storeu_si256(at(missesHi), _mm256_or_si256(oldMissHi, _mm256_andnot_si256(occHi, hi)));
+
+        __m256i sunkLoV = _mm256_loadu_si256(at(sunkLo));
+        __m256i sunkHiV = _mm256_loadu_si256(at(sunkHi));
+        __m256i sunkAny = zero;
+        __m256i ids = ones;
+        for (int ship = 0; ship < shipCount; ++ship) {
+            __m256i cellsLo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shipLo.data() + ship * stride + game));
+            __m256i cellsHi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shipHi.data() + ship * stride + game));
+            __m256i onShip = _mm256_xor_si256(ones, _mm256_cmpeq_epi64(
+                _mm256_or_si256(_mm256_and_si256(cellsLo, lo), _mm256_and_si256(cellsHi, hi)), zero));
+            __m256i whole = _mm256_cmpeq_epi64(_mm256_or_si256(_mm256_andnot_si256(newHitsLo, cellsLo),
+                                                               _mm256_andnot_si256(newHitsHi, cellsHi)), zero);
+            __m256i sunkNow = _mm256_and_si256(_mm256_and_si256(onShip, whole), fresh);
+            ids = _mm256_blendv_epi8(ids, _mm256_set1_epi64x(ship), onShip);
+            sunkAny = _mm256_or_si256(sunkAny, sunkNow);
+            sunkLoV = _mm256_or_si256(sunkLoV, _mm256_and_si256(cellsLo, sunkNow));
+            sunkHiV = _mm256_or_si256(sunkHiV, _mm256_and_si256(cellsHi, sunkNow));
+        }
+        _mm256_storeu_si256(at(sunkLo), sunkLoV);
+        _mm256_storeu_si256(at(sunkHi), sunkHiV);
+
+        int freshBits = _mm256_movemask_pd(_mm256_castsi256_pd(fresh));
+        int missBits = _mm256_movemask_pd(_mm256_castsi256_pd(miss));
+        int sunkBits = _mm256_movemask_pd(_mm256_castsi256_pd(sunkAny));
+        alignas(32) std::int64_t id[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(id), ids);
+        for (int lane = 0; lane < 4; ++lane) {
+            flags[game + lane] = ((freshBits >> lane) & 1 ? 0 : ALREADY_SHOT) |
+                                 ((missBits >> lane) & 1 ? 0 : HIT) |
+                                 ((sunkBits >> lane) & 1 ? SUNK : 0);
+            shipIds[game + lane] = static_cast<std::int8_t>(id[lane]);
+        }
+    }
+}
+
+// pickCell с n-м битом через pdep вместо перебора битов; клетки те же, что у pick()
+__attribute__((target("avx2,bmi2"))) void BatchSimulator::pickBmi2()
+{
+    for (int game = 0; game < games; ++game) {
+        shotLo[game] = shotHi[game] = 0;
+        if (!running[game]) continue;
+
+        std::uint64_t lo = optionsLo[game];
+        std::uint64_t hi = optionsHi[game];
+        int lowCount = BoardMask::popcount(lo);
+        int count = lowCount + BoardMask::popcount(hi);
+        if (count == 0) {
+            running[game] = 0;
+            continue;
+        }
+        int n = static_cast<int>((std::uint64_t(draws[game]) * static_cast<std::uint32_t>(count)) >> 32);
+        bool low = n < lowCount;
+        std::uint64_t word = low ? lo : hi;
+        int bit = BoardMask::ctz(_pdep_u64(std::uint64_t(1) << (low ? n : n - lowCount), word));
+        int cell = (low ? 0 : 64) + bit;
+        cells[game] = static_cast<std::uint8_t>(cell);
+        if (low) shotLo[game] = std::uint64_t(1) << bit;
+        else shotHi[game] = std::uint64_t(1) << bit;
+    }
+}
+
+#else
+
+// Без x86 векторные ядра недоступны, bestKernel() их не выбирает
+void BatchSimulator::pickBmi2() { pick(); }
+void BatchSimulator::resolveSse41() { resolveScalar(); }
+void BatchSimulator::resolveAvx2() { resolveScalar(); }
+
+#endif
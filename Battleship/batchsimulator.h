@@ -0,0 +1,92 @@
+#ifndef BATCHSIMULATOR_H
+#define BATCHSIMULATOR_H
+
+#include "battleshipboard.h"
+#include "fleetgenerator.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Много независимых партий, идущих в ногу: на каждом шаге каждая партия делает
+// один выстрел. Состояние разложено по массивам (структура массивов): маски
+// всех партий подряд, корабль s партии g - в shipLo/shipHi[s * stride + g]. Разбор
+// выстрелов и проверка потопления считаются сразу для 2 (SSE4.1) или 4 (AVX2)
+// партий, с AVX2 - и маски кандидатов; итог выстрела тот же, что у BattleshipBoard::attack.
+// Ядро выбирается при запуске по процессору, без флагов сборки
+class BatchSimulator
+{
+public:
+    enum Kernel { Scalar, Sse41, Avx2 };
+
+    static const int DEFAULT_GAMES = 64;
+
+    BatchSimulator(const std::vector<int>& fleet, int games = DEFAULT_GAMES);
+
+    // Лучшее ядро, которое поддерживает процессор; Avx2 требует ещё и BMI2
+    static Kernel bestKernel();
+    // Ядро, которое процессор не поддерживает, заменяется на лучшее доступное
+    void setKernel(Kernel requested);
+    Kernel kernel() const { return activeKernel; }
+
+    int gameCount() const { return games; }
+
+    // Новая партия в ячейке game; layout - как у FleetGenerator::generate
+    void startGame(int game, const FleetGenerator::Layout& layout);
+    // Один выстрел в каждой идущей партии; возвращает число партий, которые ещё идут
+    int step(std::mt19937_64& rng);
+
+    bool active(int game) const { return running[game] != 0; }
+    int shotCount(int game) const { return shots[game]; }
+    int lastCell(int game) const { return cells[game]; }
+    ShotResult lastResult(int game) const;
+
+    struct Stats {
+        std::uint64_t games = 0;
+        std::uint64_t shots = 0;
+    };
+    // Сыграть total партий, занимая освободившиеся ячейки новыми
+    Stats run(std::mt19937_64& rng, std::uint64_t total);
+
+    // Куда стрелять: продолжение ряда из двух попаданий, иначе соседи раненого
+    // корабля, иначе шахматный порядок. Клетки вокруг потопленных кораблей
+    // пропускаются - корабли не касаются друг друга
+    static BoardMask candidates(const BoardMask& hits, const BoardMask& misses, const BoardMask& sunk);
+    // Случайная клетка из непустой маски; random - 32 случайных бита
+    static int pickCell(const BoardMask& options, std::uint32_t random);
+
+private:
+    std::vector<int> fleet;
+    FleetGenerator generator;
+    int games;
+    int stride;  // число партий, дополненное до кратного 4
+    Kernel activeKernel;
+
+    std::vector<std::uint64_t> occupiedLo, occupiedHi;
+    std::vector<std::uint64_t> hitsLo, hitsHi;
+    std::vector<std::uint64_t> missesLo, missesHi;
+    std::vector<std::uint64_t> sunkLo, sunkHi;
+    std::vector<std::uint64_t> shotLo, shotHi;   // выстрел текущего шага, 0 у стоящих партий
+    std::vector<std::uint64_t> optionsLo, optionsHi;  // candidates() всех партий
+    std::vector<std::uint64_t> shipLo, shipHi;   // BattleshipBoard::MAX_SHIPS * stride
+
+    std::vector<std::uint32_t> draws;  // случайные биты для выбора клетки
+
+    // Итог шага по партиям: биты уже обстреляна/попадание/потопление и номер корабля
+    std::vector<std::uint8_t> flags;
+    std::vector<std::int8_t> shipIds;
+
+    std::vector<std::uint8_t> running;
+    std::vector<std::uint8_t> afloat;
+    std::vector<std::uint8_t> outcomes;
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint16_t> shots;
+
+    void aim();
+    void pick();
+    void pickBmi2();
+    void resolveScalar();
+    void resolveSse41();
+    void resolveAvx2();
+};
+
+#endif
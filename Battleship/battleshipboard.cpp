@@ -0,0 +1,148 @@
+#include "battleshipboard.h"
+
+BattleshipBoard::BattleshipBoard()
+{
+    clear();
+}
+
+void BattleshipBoard::clear()
+{
+    occupied = BoardMask();
+    blocked = BoardMask();
+    hits = BoardMask();
+    misses = BoardMask();
+    shipMasks.fill(BoardMask());
+    remainingHits.fill(0);
+    cellShip.fill(-1);
+    ships = 0;
+    afloat = 0;
+}
+
+bool BattleshipBoard::canPlaceShip(int row, int col, int length, bool horizontal) const
+{
+    return canPlaceShip(shipMask(row, col, length, horizontal));
+}
+
+BoardMask BattleshipBoard::legalAnchors(int length, bool horizontal) const
+{
+    if (length <= 0 || length > SIZE) {
+        return BoardMask();
+    }
+    // Диапазон начал не даёт кораблю перейти через край, поэтому сдвиги не заворачивают строку
+    BoardMask free = FULL_MASK & ~blocked;
+    BoardMask anchors = free & ANCHOR_RANGES[length * 2 + horizontal];
+    int step = horizontal ? 1 : SIZE;
+    for (int i = 1; i < length && anchors.any(); ++i) {
+        anchors &= free.shifted(-i * step);
+    }
+    return anchors;
+}
+
+void BattleshipBoard::placeShip(int shipId, int row, int col, int length, bool horizontal)
+{
+    if (shipId < 0 || shipId >= MAX_SHIPS) {
+        return;
+    }
+    // Повторная расстановка того же корабля заменяет прежний, а не добавляет ещё один
+    if (shipMasks[shipId].any()) {
+        removeShip(shipId);
+    }
+    BoardMask ship = shipMask(row, col, length, horizontal);
+    if (ship.none()) {
+        return;
+    }
+    shipMasks[shipId] = ship;
+    remainingHits[shipId] = ship.count();
+    occupied |= ship;
+    blocked |= neighbourhood(ship);
+    for (BoardMask cells = ship; cells.any();) {
+        cellShip[cells.popFirst()] = static_cast<std::int8_t>(shipId);
+    }
+    if (shipId >= ships) {
+        ships = shipId + 1;
+    }
+    afloat++;
+}
+
+void BattleshipBoard::removeShip(int shipId)
+{
+    if (remainingHits[shipId] > 0) {
+        afloat--;
+    }
+    occupied &= ~shipMasks[shipId];
+    for (BoardMask cells = shipMasks[shipId]; cells.any();) {
+        cellShip[cells.popFirst()] = -1;
+    }
+    shipMasks[shipId] = BoardMask();
+    remainingHits[shipId] = 0;
+    // Соседние клетки у кораблей могут совпадать, поэтому ореол собирается заново
+    blocked = BoardMask();
+    for (int other = 0; other < ships; ++other) {
+        blocked |= neighbourhood(shipMasks[other]);
+    }
+}
+
+ShotResult BattleshipBoard::attack(int row, int col)
+{
+    int index = cellIndex(row, col);
+    BoardMask cell = BoardMask::bit(index);
+    if (((hits | misses) & cell).any()) {
+        return {ShotResult::AlreadyShot, cellShip[index]};
+    }
+
+    int shipId = cellShip[index];
+    if (shipId < 0) {
+        misses |= cell;
+        return {ShotResult::Miss, -1};
+    }
+
+    hits |= cell;
+    if (--remainingHits[shipId] > 0) {
+        return {ShotResult::Hit, shipId};
+    }
+    return {--afloat == 0 ? ShotResult::FleetDestroyed : ShotResult::Sunk, shipId};
+}
+
+SalvoResult BattleshipBoard::attack(const BoardMask& shots)
+{
+    SalvoResult salvo;
+    BoardMask fresh = shots & unshotCells();
+    BoardMask taken;
+    while (fresh.any() && salvo.count < SalvoResult::MAX_SHOTS) {
+        int index = fresh.popFirst();
+        taken.set(index);
+        salvo.cells[salvo.count++] = static_cast<std::uint8_t>(index);
+    }
+    salvo.hits = taken & occupied;
+    salvo.misses = taken & ~occupied;
+    hits |= salvo.hits;
+    misses |= salvo.misses;
+
+    // Сколько попаданий залпа пришлось на каждый корабль
+    std::array<int, MAX_SHIPS> shipHits{};
+    for (int shipId = 0; shipId < ships; ++shipId) {
+        shipHits[shipId] = (shipMasks[shipId] & salvo.hits).count();
+        if (shipHits[shipId] == 0) continue;
+        remainingHits[shipId] -= shipHits[shipId];
+        if (remainingHits[shipId] == 0) {
+            salvo.sunk |= shipMasks[shipId];
+            salvo.sunkShips++;
+        }
+    }
+    afloat -= salvo.sunkShips;
+
+    int sinkingLeft = salvo.sunkShips;
+    for (int shot = 0; shot < salvo.count; ++shot) {
+        int shipId = cellShip[salvo.cells[shot]];
+        ShotResult& result = salvo.results[shot];
+        if (shipId < 0) {
+            result = {ShotResult::Miss, -1};
+        } else if (--shipHits[shipId] > 0 || remainingHits[shipId] > 0) {
+            result = {ShotResult::Hit, shipId};
+        } else {
+            --sinkingLeft;
+            result = {afloat == 0 && sinkingLeft == 0 ? ShotResult::FleetDestroyed : ShotResult::Sunk, shipId};
+        }
+    }
+    return salvo;
+}
@@ -0,0 +1,165 @@
+#ifndef BATTLESHIPBOARD_H
+#define BATTLESHIPBOARD_H
+
+#include "boardmask.h"
+#include <array>
+#include <cstdint>
+
+namespace BoardGeometry {
+
+constexpr int SIZE = 10;
+
+// 0 - всё поле, 1 - шахматный порядок, 2 - без последнего столбца, 3 - без первого
+constexpr BoardMask mask(int kind)
+{
+    BoardMask result;
+    for (int row = 0; row < SIZE; ++row) {
+        for (int col = 0; col < SIZE; ++col) {
+            bool include = kind == 0 ||
+                           (kind == 1 && (row + col) % 2 == 0) ||
+                           (kind == 2 && col != SIZE - 1) ||
+                           (kind == 3 && col != 0);
+            if (include) result.set(row * SIZE + col);
+        }
+    }
+    return result;
+}
+
+// Клетки, от которых корабль длины length помещается на поле; индекс length * 2 + horizontal
+constexpr std::array<BoardMask, 2 * (SIZE + 1)> anchorRanges()
+{
+    std::array<BoardMask, 2 * (SIZE + 1)> ranges{};
+    for (int length = 1; length <= SIZE; ++length) {
+        for (int row = 0; row < SIZE; ++row) {
+            for (int col = 0; col < SIZE; ++col) {
+                if (row + length <= SIZE) ranges[length * 2].set(row * SIZE + col);
+                if (col + length <= SIZE) ranges[length * 2 + 1].set(row * SIZE + col);
+            }
+        }
+    }
+    return ranges;
+}
+
+}
+
+struct ShotResult
+{
+    enum Outcome { AlreadyShot, Miss, Hit, Sunk, FleetDestroyed };
+    
+    Outcome outcome;
+    int shipId;  // -1, если корабль не задет
+    
+    bool hit() const { return outcome >= Hit; }
+    bool sunk() const { return outcome >= Sunk; }
+};
+
+// Итог залпа. Выстрелы перечислены по возрастанию клетки; потопленным корабль
+// считается на последнем попавшем в него выстреле залпа
+struct SalvoResult
+{
+    static constexpr int MAX_SHOTS = 10;
+    
+    BoardMask hits;
+    BoardMask misses;
+    BoardMask sunk;  // клетки кораблей, потопленных этим залпом
+    int sunkShips = 0;
+    int count = 0;
+    std::array<std::uint8_t, MAX_SHOTS> cells{};
+    std::array<ShotResult, MAX_SHOTS> results{};
+    
+    bool fleetDestroyed() const { return count > 0 && results[count - 1].outcome == ShotResult::FleetDestroyed; }
+};
+
+// Поле морского боя на битовых масках: занятые клетки, попадания, промахи и маска каждого корабля
+class BattleshipBoard
+{
+public:
+    static constexpr int SIZE = BoardGeometry::SIZE;
+    static constexpr int CELL_COUNT = SIZE * SIZE;
+    static constexpr int MAX_SHIPS = 10;
+
+    BattleshipBoard();
+
+    void clear();
+
+    static constexpr int cellIndex(int row, int col) { return row * SIZE + col; }
+    static constexpr bool inBounds(int row, int col)
+    {
+        return row >= 0 && row < SIZE && col >= 0 && col < SIZE;
+    }
+
+    static constexpr BoardMask FULL_MASK = BoardGeometry::mask(0);
+    static constexpr BoardMask CHECKERBOARD_MASK = BoardGeometry::mask(1);
+
+    // Клетки корабля; пустая маска, если корабль не помещается на поле
+    static constexpr BoardMask shipMask(int row, int col, int length, bool horizontal)
+    {
+        BoardMask mask;
+        if (!inBounds(row, col) || length <= 0 ||
+            (horizontal ? col + length > SIZE : row + length > SIZE)) {
+            return mask;
+        }
+        for (int i = 0; i < length; ++i) {
+            mask.set(horizontal ? cellIndex(row, col + i) : cellIndex(row + i, col));
+        }
+        return mask;
+    }
+
+    // Маска вместе со всеми соседними клетками (включая диагональные)
+    static constexpr BoardMask neighbourhood(const BoardMask& mask)
+    {
+        BoardMask row = mask | (mask & NOT_LAST_COL).shifted(1) |
+                        (mask & NOT_FIRST_COL).shifted(-1);
+        return (row | row.shifted(SIZE) | row.shifted(-SIZE)) & FULL_MASK;
+    }
+
+    bool canPlaceShip(int row, int col, int length, bool horizontal) const;
+    bool canPlaceShip(const BoardMask& ship) const
+    {
+        return ship.any() && (ship & blocked).none();
+    }
+    // Все клетки, от которых корабль можно поставить: length сдвигов маски свободных клеток
+    BoardMask legalAnchors(int length, bool horizontal) const;
+    // Корабль с уже занятым shipId заменяет прежний; shipId вне 0..MAX_SHIPS-1 и корабль,
+    // не помещающийся на поле, не ставятся (прежний корабль с этим shipId всё равно убирается)
+    void placeShip(int shipId, int row, int col, int length, bool horizontal);
+
+    // Выстрел по клетке; счётчики попаданий и кораблей на плаву обновляются за O(1)
+    ShotResult attack(int row, int col);
+    // Залп одним обновлением масок; уже обстрелянные клетки и выстрелы
+    // сверх SalvoResult::MAX_SHOTS пропускаются
+    SalvoResult attack(const BoardMask& shots);
+
+    int shipAt(int row, int col) const { return cellShip[cellIndex(row, col)]; }
+    bool isShot(int row, int col) const { return shotCells().test(cellIndex(row, col)); }
+    bool isSunk(int shipId) const { return shipMasks[shipId].any() && remainingHits[shipId] == 0; }
+    bool allSunk() const { return afloat == 0; }
+    int shipsAfloat() const { return afloat; }
+
+    int shipCount() const { return ships; }
+    const BoardMask& occupiedCells() const { return occupied; }
+    const BoardMask& hitCells() const { return hits; }
+    const BoardMask& missCells() const { return misses; }
+    const BoardMask& shipCells(int shipId) const { return shipMasks[shipId]; }
+    BoardMask shotCells() const { return hits | misses; }
+    BoardMask unshotCells() const { return FULL_MASK & ~(hits | misses); }
+
+private:
+    BoardMask occupied;
+    BoardMask blocked;  // корабли вместе с соседними клетками
+    BoardMask hits;
+    BoardMask misses;
+    std::array<BoardMask, MAX_SHIPS> shipMasks;
+    std::array<int, MAX_SHIPS> remainingHits;
+    std::array<std::int8_t, CELL_COUNT> cellShip;
+    int ships;
+    int afloat;
+
+    void removeShip(int shipId);
+
+    static constexpr BoardMask NOT_LAST_COL = BoardGeometry::mask(2);
+    static constexpr BoardMask NOT_FIRST_COL = BoardGeometry::mask(3);
+    static constexpr std::array<BoardMask, 2 * (SIZE + 1)> ANCHOR_RANGES = BoardGeometry::anchorRanges();
+};
+
+#endif
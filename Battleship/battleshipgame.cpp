@@ -1,163 +1,66 @@
 #include "battleshipgame.h"
+#include "massivegame.h"
+#include "bimarugame.h"
 #include <QApplication>
 #include <QProcess>
 #include <QCoreApplication>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <algorithm>
 
+namespace {
 
-GridCell::GridCell(int row, int col, QWidget* parent)
-    : QPushButton(parent), row(row), col(col), state(Empty)
-{
-    setFixedSize(30, 30);
-    setStyleSheet("QPushButton { border: 1px solid black; background-color: lightblue; }");
-}
+const std::uint32_t MIN_HEATMAP_GAMES = 3;
 
-void GridCell::setState(CellState newState)
+QString dataPath(const QString& fileName)
 {
-    state = newState;
-    update();
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/" + fileName;
 }
 
-void GridCell::paintEvent(QPaintEvent* event)
+QString gameLogPath()
 {
-    QPushButton::paintEvent(event);
-    
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-    
-    switch (state) {
-        case Ship:
-            painter.fillRect(rect(), QColor(100, 100, 100));
-            break;
-        case Hit:
-            painter.fillRect(rect(), QColor(255, 0, 0));
-            painter.setPen(QPen(Qt::white, 2));
-            painter.drawLine(5, 5, 25, 25);
-            painter.drawLine(25, 5, 5, 25);
-            break;
-        case Miss:
-            painter.fillRect(rect(), QColor(0, 0, 255, 100));
-            painter.setPen(QPen(Qt::blue, 3));
-            painter.drawEllipse(10, 10, 10, 10);
-            break;
-        case Sunk:
-            painter.fillRect(rect(), QColor(139, 0, 0));
-            break;
-        default:
-            break;
-    }
+    return dataPath("battleship.bslog");
 }
 
-void GridCell::mousePressEvent(QMouseEvent* event)
+QString heatmapPath()
 {
-    if (event->button() == Qt::LeftButton) {
-        emit cellClicked(row, col);
-    } else if (event->button() == Qt::RightButton) {
-        emit cellRightClicked(row, col);
-    }
-    QPushButton::mousePressEvent(event);
+    return dataPath("shot_heatmap.bin");
 }
 
-AIPlayer::AIPlayer() : currentMode(Random), currentDirection(0), rng(std::random_device{}())
+QString placementPriorPath()
 {
-    directions = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    return dataPath("placement_prior.bin");
 }
 
-std::pair<int, int> AIPlayer::makeMove(const std::vector<std::vector<int>>& board)
-{
-    while (!targetQueue.empty()) {
-        auto move = targetQueue.back();
-        targetQueue.pop_back();
-        if (isValidCell(move.first, move.second, board)) {
-            return move;
-        }
-    }
-    
-    if (currentMode == Target && lastHit.first != -1) {
-        for (auto& dir : directions) {
-            int newRow = lastHit.first + dir.first;
-            int newCol = lastHit.second + dir.second;
-            if (isValidCell(newRow, newCol, board)) {
-                return {newRow, newCol};
-            }
-        }
-
-        currentMode = Random;
-    }
-    
-    std::vector<std::pair<int, int>> availableMoves;
-    for (int i = 0; i < 10; ++i) {
-        for (int j = 0; j < 10; ++j) {
-            if (board[i][j] == 0) {
-                availableMoves.push_back({i, j});
-            }
-        }
-    }
-    
-    if (availableMoves.empty()) {
-        return {-1, -1};
-    }
-    
-    std::vector<std::pair<int, int>> priorityMoves;
-    for (auto& move : availableMoves) {
-        if ((move.first + move.second) % 2 == 0) {
-            priorityMoves.push_back(move);
-        }
-    }
-    
-    auto& movesToChoose = priorityMoves.empty() ? availableMoves : priorityMoves;
-    std::uniform_int_distribution<> dis(0, movesToChoose.size() - 1);
-    return movesToChoose[dis(rng)];
-}
-
-
-bool AIPlayer::isValidCell(int row, int col, const std::vector<std::vector<int>>& board)
-{
-    return row >= 0 && row < 10 && col >= 0 && col < 10 &&
-           board[row][col] != 2 && board[row][col] != 3;
-}
-
-
-void AIPlayer::updateResult(int row, int col, bool hit, bool sunk)
-{
-    if (hit && !sunk) {
-        currentMode = Target;
-        lastHit = {row, col};
-        
-        for (auto& dir : directions) {
-            int newRow = row + dir.first;
-            int newCol = col + dir.second;
-            if (newRow >= 0 && newRow < 10 && newCol >= 0 && newCol < 10) {
-                targetQueue.push_back({newRow, newCol});
-            }
-        }
-    } else if (sunk) {
-        currentMode = Random;
-        targetQueue.clear();
-        lastHit = {-1, -1};
-    }
-}
-
-
-void AIPlayer::addAdjacentCells(int row, int col)
-{
-    for (auto& dir : directions) {
-        int newRow = row + dir.first;
-        int newCol = col + dir.second;
-        if (newRow >= 0 && newRow < 10 && newCol >= 0 && newCol < 10) {
-            targetQueue.push_back({newRow, newCol});
-        }
-    }
 }
 
 
 BattleshipGame::BattleshipGame(QWidget* parent)
     : QMainWindow(parent), currentShipIndex(0), placementPhase(true),
-      gameActive(false), playerTurn(true)
+      gameActive(false), playerTurn(true), salvoMode(false), hoverRow(-1), hoverCol(-1),
+      rng(std::random_device{}()),
+      ai(AIPlayer::BackgroundDensity), replayMode(false), replayGameNumber(0),
+      networkMode(false), networkHost(false)
 {
+    gameLog.open(gameLogPath());
+    shotHeatmap.load(heatmapPath());
+    placementPrior.open(placementPriorPath());
     setupUI();
     initializeGame();
     
+    netLink = new NetLink(this);
+    connect(netLink, &NetLink::connected, this, &BattleshipGame::onNetworkConnected);
+    connect(netLink, &NetLink::messageReceived, this, &BattleshipGame::onNetworkMessage);
+    connect(netLink, &NetLink::failed, this, &BattleshipGame::onNetworkLost);
+    connect(netLink, &NetLink::disconnected, this, [this]() {
+        onNetworkLost("Противник отключился");
+    });
+    
     aiTimer = new QTimer(this);
     aiTimer->setSingleShot(true);
     connect(aiTimer, &QTimer::timeout, this, &BattleshipGame::aiMove);
@@ -181,6 +84,55 @@ void BattleshipGame::setupUI()
     });
     topLayout->addWidget(menuButton);
     
+    replayButton = new QPushButton("Повтор партии", this);
+    replayButton->setStyleSheet("QPushButton { font-size: 12px; padding: 5px; }");
+    connect(replayButton, &QPushButton::clicked, this, &BattleshipGame::openReplay);
+    topLayout->addWidget(replayButton);
+    
+    networkButton = new QPushButton("Игра по сети", this);
+    networkButton->setStyleSheet("QPushButton { font-size: 12px; padding: 5px; }");
+    connect(networkButton, &QPushButton::clicked, this, &BattleshipGame::openNetworkGame);
+    topLayout->addWidget(networkButton);
+    
+    auto* massiveButton = new QPushButton("Большое поле", this);
+    massiveButton->setStyleSheet("QPushButton { font-size: 12px; padding: 5px; }");
+    connect(massiveButton, &QPushButton::clicked, this, [this]() {
+        bool ok = false;
+        int size = QInputDialog::getInt(this, "Большое поле", "Размер поля:", 100,
+                                        BOARD_SIZE, SparseBoard::MAX_SIZE, 10, &ok);
+        if (ok) {
+            auto* game = new MassiveGame(size);
+            game->setAttribute(Qt::WA_DeleteOnClose);
+            game->show();
+        }
+    });
+    topLayout->addWidget(massiveButton);
+    
+    auto* puzzleButton = new QPushButton("Головоломка", this);
+    puzzleButton->setStyleSheet("QPushButton { font-size: 12px; padding: 5px; }");
+    connect(puzzleButton, &QPushButton::clicked, this, [this]() {
+        bool ok = false;
+        QString size = QInputDialog::getItem(this, "Бимару", "Размер поля:",
+                                             {"10", "15", "20"}, 0, false, &ok);
+        if (ok) {
+            auto* game = new BimaruGame(size.toInt());
+            game->setAttribute(Qt::WA_DeleteOnClose);
+            game->show();
+        }
+    });
+    topLayout->addWidget(puzzleButton);
+    
+    placementCombo = new QComboBox(this);
+    placementCombo->addItem("Флот ИИ: случайно");
+    placementCombo->addItem("Флот ИИ: против игрока");
+    placementCombo->setCurrentIndex(1);
+    topLayout->addWidget(placementCombo);
+    
+    rulesCombo = new QComboBox(this);
+    rulesCombo->addItem("Обычные правила");
+    rulesCombo->addItem("Залп");
+    topLayout->addWidget(rulesCombo);
+    
     mainLayout->addLayout(topLayout);
     
     statusLabel = new QLabel("Расставьте корабли. ПКМ - поворот корабля", this);
@@ -188,6 +140,13 @@ void BattleshipGame::setupUI()
     statusLabel->setStyleSheet("QLabel { font-size: 14px; font-weight: bold; }");
     mainLayout->addWidget(statusLabel);
     
+    advisorLabel = new QLabel(this);
+    advisorLabel->setAlignment(Qt::AlignCenter);
+    mainLayout->addWidget(advisorLabel);
+    advisorTimer = new QTimer(this);
+    advisorTimer->setInterval(250);
+    connect(advisorTimer, &QTimer::timeout, this, &BattleshipGame::updateAdvisorLabel);
+    
     auto* boardsLayout = new QHBoxLayout();
     
     auto* playerSection = new QVBoxLayout();
@@ -195,20 +154,24 @@ void BattleshipGame::setupUI()
     playerLabel->setAlignment(Qt::AlignCenter);
     playerSection->addWidget(playerLabel);
     
-    auto* playerWidget = new QWidget();
-    playerGrid = new QGridLayout(playerWidget);
-    playerGrid->setSpacing(1);
-    playerSection->addWidget(playerWidget);
+    playerView = new BoardWidget(BOARD_SIZE, BOARD_SIZE, this);
+    connect(playerView, &BoardWidget::cellClicked,
+            this, &BattleshipGame::onPlayerCellClicked);
+    connect(playerView, &BoardWidget::cellRightClicked,
+            this, &BattleshipGame::onPlayerCellRightClicked);
+    connect(playerView, &BoardWidget::cellHovered,
+            this, &BattleshipGame::onPlayerCellHovered);
+    playerSection->addWidget(playerView, 0, Qt::AlignCenter);
     
     auto* enemySection = new QVBoxLayout();
     enemyLabel = new QLabel("Поле противника", this);
     enemyLabel->setAlignment(Qt::AlignCenter);
     enemySection->addWidget(enemyLabel);
     
-    auto* enemyWidget = new QWidget();
-    enemyGrid = new QGridLayout(enemyWidget);
-    enemyGrid->setSpacing(1);
-    enemySection->addWidget(enemyWidget);
+    enemyView = new BoardWidget(BOARD_SIZE, BOARD_SIZE, this);
+    connect(enemyView, &BoardWidget::cellClicked,
+            this, &BattleshipGame::onEnemyCellClicked);
+    enemySection->addWidget(enemyView, 0, Qt::AlignCenter);
     
     boardsLayout->addLayout(playerSection);
     boardsLayout->addSpacing(50);
@@ -216,30 +179,29 @@ void BattleshipGame::setupUI()
     
     mainLayout->addLayout(boardsLayout);
     
+    replayBar = new QWidget(this);
+    auto* replayLayout = new QHBoxLayout(replayBar);
+    auto* backButton = new QPushButton("◀", replayBar);
+    auto* forwardButton = new QPushButton("▶", replayBar);
+    replaySlider = new QSlider(Qt::Horizontal, replayBar);
+    connect(backButton, &QPushButton::clicked, this, [this]() {
+        replaySlider->setValue(replaySlider->value() - 1);
+    });
+    connect(forwardButton, &QPushButton::clicked, this, [this]() {
+        replaySlider->setValue(replaySlider->value() + 1);
+    });
+    connect(replaySlider, &QSlider::valueChanged, this, &BattleshipGame::onReplaySliderMoved);
+    replayLayout->addWidget(backButton);
+    replayLayout->addWidget(replaySlider);
+    replayLayout->addWidget(forwardButton);
+    replayBar->hide();
+    mainLayout->addWidget(replayBar);
+    
     restartButton = new QPushButton("Новая игра", this);
     restartButton->setStyleSheet("QPushButton { font-size: 12px; padding: 10px; }");
     connect(restartButton, &QPushButton::clicked, this, &BattleshipGame::restartGame);
     mainLayout->addWidget(restartButton);
     
-    playerCells.resize(BOARD_SIZE, std::vector<GridCell*>(BOARD_SIZE));
-    enemyCells.resize(BOARD_SIZE, std::vector<GridCell*>(BOARD_SIZE));
-    
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            playerCells[i][j] = new GridCell(i, j, this);
-            connect(playerCells[i][j], &GridCell::cellClicked,
-                    this, &BattleshipGame::onPlayerCellClicked);
-            connect(playerCells[i][j], &GridCell::cellRightClicked,
-                    this, &BattleshipGame::onPlayerCellRightClicked);
-            playerGrid->addWidget(playerCells[i][j], i, j);
-            
-            enemyCells[i][j] = new GridCell(i, j, this);
-            connect(enemyCells[i][j], &GridCell::cellClicked,
-                    this, &BattleshipGame::onEnemyCellClicked);
-            enemyGrid->addWidget(enemyCells[i][j], i, j);
-        }
-    }
-    
     setWindowTitle("Морской бой");
     resize(800, 600);
 }
@@ -247,24 +209,40 @@ void BattleshipGame::setupUI()
 
 void BattleshipGame::initializeGame()
 {
-    playerBoard.assign(BOARD_SIZE, std::vector<int>(BOARD_SIZE, 0));
-    enemyBoard.assign(BOARD_SIZE, std::vector<int>(BOARD_SIZE, 0));
+    playerBoard.clear();
+    enemyBoard.clear();
     
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            playerCells[i][j]->setState(GridCell::Empty);
-            enemyCells[i][j]->setState(GridCell::Empty);
-        }
-    }
+    playerView->clear();
+    enemyView->clear();
+    shownAnchors = BoardMask();
+    previewCells = BoardMask();
     
     createShips();
-    placeEnemyShips();
+    if (!networkMode) {
+        placeEnemyShips();
+    }
+    
+    std::vector<int> fleet;
+    for (auto& ship : playerShips) {
+        fleet.push_back(ship.length);
+    }
+    ai.setPlacementPrior(placementPrior.weights());
+    ai.reset(fleet);
+    
+    playerShotOrder.clear();
+    
+    // Сетевой протокол рассчитан на одиночные выстрелы
+    salvoMode = !networkMode && rulesCombo->currentIndex() == 1;
+    playerSalvo = BoardMask();
     
     currentShipIndex = 0;
     placementPhase = true;
     gameActive = false;
     playerTurn = true;
     
+    updateLegalAnchors();
+    highlightShipPlacement(hoverRow, hoverCol);
+    restartAdvisor();
     updateStatusLabel();
 }
 
@@ -289,72 +267,29 @@ void BattleshipGame::createShips()
 
 void BattleshipGame::placeEnemyShips()
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    
-    for (int shipIdx = 0; shipIdx < enemyShips.size(); ++shipIdx) {
-        Ship& ship = enemyShips[shipIdx];
-        bool placed = false;
-        int attempts = 0;
-        
-        while (!placed && attempts < 1000) {
-            std::uniform_int_distribution<> rowDis(0, BOARD_SIZE - 1);
-            std::uniform_int_distribution<> colDis(0, BOARD_SIZE - 1);
-            std::uniform_int_distribution<> orientDis(0, 1);
-            
-            int row = rowDis(gen);
-            int col = colDis(gen);
-            bool horizontal = orientDis(gen);
-            
-            if (canPlaceShip(enemyBoard, row, col, ship.length, horizontal)) {
-                placeShip(enemyBoard, row, col, ship.length, horizontal, shipIdx + 1);
-                ship.row = row;
-                ship.col = col;
-                ship.horizontal = horizontal;
-                placed = true;
-            }
-            attempts++;
-        }
+    std::vector<int> fleet;
+    for (auto& ship : enemyShips) {
+        fleet.push_back(ship.length);
     }
-}
-
-bool BattleshipGame::canPlaceShip(const std::vector<std::vector<int>>& board,
-                                  int row, int col, int length, bool horizontal)
-{
-    if (horizontal) {
-        if (col + length > BOARD_SIZE) return false;
-    } else {
-        if (row + length > BOARD_SIZE) return false;
-    }
-    
-    for (int i = -1; i <= 1; ++i) {
-        for (int j = -1; j <= 1; ++j) {
-            for (int k = 0; k < length; ++k) {
-                int checkRow = row + (horizontal ? i : i + k);
-                int checkCol = col + (horizontal ? j + k : j);
-                
-                if (checkRow >= 0 && checkRow < BOARD_SIZE &&
-                    checkCol >= 0 && checkCol < BOARD_SIZE) {
-                    if (board[checkRow][checkCol] != 0) {
-                        return false;
-                    }
-                }
-            }
-        }
+    
+    FleetGenerator generator(fleet);
+    FleetGenerator::Layout layout;
+    // Против игрока: корабли там, куда игроки обычно добираются в последнюю очередь
+    bool adversarial = placementCombo->currentIndex() == 1 &&
+                       shotHeatmap.gameCount() >= MIN_HEATMAP_GAMES;
+    bool placed = adversarial ? shotHeatmap.chooseLayout(generator, rng, layout)
+                              : generator.generate(rng, layout);
+    if (!placed) {
+        return;
     }
     
-    return true;
-}
-
-void BattleshipGame::placeShip(std::vector<std::vector<int>>& board, int row, int col,
-                               int length, bool horizontal, int shipId)
-{
-    for (int i = 0; i < length; ++i) {
-        if (horizontal) {
-            board[row][col + i] = shipId;
-        } else {
-            board[row + i][col] = shipId;
-        }
+    for (int shipIdx = 0; shipIdx < static_cast<int>(enemyShips.size()); ++shipIdx) {
+        Ship& ship = enemyShips[shipIdx];
+        const ShipPlacement& placement = *layout[shipIdx];
+        enemyBoard.placeShip(shipIdx, placement.row, placement.col, ship.length, placement.horizontal);
+        ship.row = placement.row;
+        ship.col = placement.col;
+        ship.horizontal = placement.horizontal;
     }
 }
 
@@ -366,24 +301,36 @@ void BattleshipGame::onPlayerCellClicked(int row, int col)
     
     Ship& ship = playerShips[currentShipIndex];
     
-    if (canPlaceShip(playerBoard, row, col, ship.length, ship.horizontal)) {
-        placeShip(playerBoard, row, col, ship.length, ship.horizontal, currentShipIndex + 1);
+    if (playerBoard.canPlaceShip(row, col, ship.length, ship.horizontal)) {
+        playerBoard.placeShip(currentShipIndex, row, col, ship.length, ship.horizontal);
         ship.row = row;
         ship.col = col;
         
         for (int i = 0; i < ship.length; ++i) {
             int shipRow = ship.horizontal ? row : row + i;
             int shipCol = ship.horizontal ? col + i : col;
-            playerCells[shipRow][shipCol]->setState(GridCell::Ship);
+            playerView->setState(shipRow, shipCol, BoardWidget::Ship);
         }
         
         currentShipIndex++;
+        restartAdvisor();
         
         if (allShipsPlaced()) {
             placementPhase = false;
+            clearHighlights();
+            if (networkMode) {
+                if (netLink->isConnected()) {
+                    startNetworkGame();
+                }
+                updateStatusLabel();
+                return;
+            }
             gameActive = true;
+            gameRecord.beginGame(playerBoard, enemyBoard);
             updateStatusLabel();
         } else {
+            updateLegalAnchors();
+            highlightShipPlacement(row, col);
             updateStatusLabel();
         }
     }
@@ -400,10 +347,94 @@ void BattleshipGame::rotateCurrentShip()
 {
     if (currentShipIndex < playerShips.size()) {
         playerShips[currentShipIndex].horizontal = !playerShips[currentShipIndex].horizontal;
+        updateLegalAnchors();
+        highlightShipPlacement(hoverRow, hoverCol);
         updateStatusLabel();
     }
 }
 
+void BattleshipGame::onPlayerCellHovered(int row, int col)
+{
+    hoverRow = row;
+    hoverCol = col;
+    if (placementPhase && !allShipsPlaced()) {
+        highlightShipPlacement(row, col);
+    }
+}
+
+void BattleshipGame::updateLegalAnchors()
+{
+    legalAnchors = allShipsPlaced() ? BoardMask()
+        : playerBoard.legalAnchors(playerShips[currentShipIndex].length,
+                                   playerShips[currentShipIndex].horizontal);
+}
+
+void BattleshipGame::highlightShipPlacement(int row, int col)
+{
+    // Контур корабля от клетки под курсором, обрезанный краем поля
+    BoardMask footprint;
+    bool valid = false;
+    if (BattleshipBoard::inBounds(row, col) && !allShipsPlaced()) {
+        const Ship& ship = playerShips[currentShipIndex];
+        for (int i = 0; i < ship.length; ++i) {
+            int shipRow = ship.horizontal ? row : row + i;
+            int shipCol = ship.horizontal ? col + i : col;
+            if (BattleshipBoard::inBounds(shipRow, shipCol)) {
+                footprint.set(BattleshipBoard::cellIndex(shipRow, shipCol));
+            }
+        }
+        valid = legalAnchors.test(BattleshipBoard::cellIndex(row, col));
+    }
+    
+    // Перерисовываем только клетки, у которых подсказка могла измениться
+    BoardMask changed = (legalAnchors ^ shownAnchors) | footprint | previewCells;
+    BoardWidget::Overlay preview = valid ? BoardWidget::PreviewValid : BoardWidget::PreviewInvalid;
+    while (changed.any()) {
+        int cell = changed.popFirst();
+        BoardWidget::Overlay overlay = footprint.test(cell) ? preview
+            : legalAnchors.test(cell) ? BoardWidget::AnchorMark : BoardWidget::NoOverlay;
+        playerView->setOverlay(cell / BOARD_SIZE, cell % BOARD_SIZE, overlay);
+    }
+    shownAnchors = legalAnchors;
+    previewCells = footprint;
+}
+
+void BattleshipGame::clearHighlights()
+{
+    legalAnchors = BoardMask();
+    highlightShipPlacement(-1, -1);
+}
+
+void BattleshipGame::restartAdvisor()
+{
+    // Прежняя оценка отменяется, не дожидаясь потоков
+    std::vector<int> fleet;
+    for (const auto& ship : playerShips) {
+        fleet.push_back(ship.length);
+    }
+    advisor.evaluate(playerBoard, fleet, placementPrior.weights());
+    advisorTimer->start();
+    updateAdvisorLabel();
+}
+
+void BattleshipGame::updateAdvisorLabel()
+{
+    PlacementAdvisor::Estimate estimate = advisor.estimate();
+    if (estimate.finished) {
+        advisorTimer->stop();
+    }
+    if (estimate.games == 0) {
+        advisorLabel->setText(estimate.finished ? "Живучесть: остальные корабли не помещаются"
+                                                : "Живучесть: считается...");
+        return;
+    }
+    // 95% интервал по нормальному приближению
+    advisorLabel->setText(QString("Живучесть расстановки: ИИ нужно %1 ± %2 выстрелов (%3 партий)")
+                          .arg(estimate.meanShots, 0, 'f', 1)
+                          .arg(1.96 * estimate.standardError, 0, 'f', 1)
+                          .arg(estimate.games));
+}
+
 bool BattleshipGame::allShipsPlaced()
 {
     return currentShipIndex >= playerShips.size();
@@ -414,17 +445,34 @@ void BattleshipGame::onEnemyCellClicked(int row, int col)
     if (!gameActive || !playerTurn) {
         return;
     }
+    
+    if (salvoMode) {
+        aimSalvo(row, col);
+        return;
+    }
 
-    GridCell::CellState currentState = enemyCells[row][col]->getState();
-    if (currentState != GridCell::Empty) {
+    if (enemyView->getState(row, col) != BoardWidget::Empty) {
         return;
     }
     
-    bool hit = attackCell(enemyBoard, enemyCells, enemyShips, row, col);
+    if (networkMode) {
+        // Результат придёт ответом противника
+        if (netMatch.shoot(row, col)) {
+            sendNetwork();
+            playerShotOrder.push_back(BattleshipBoard::cellIndex(row, col));
+            playerTurn = false;
+            updateStatusLabel();
+        }
+        return;
+    }
+    
+    ShotResult result = attackCell(enemyBoard, enemyView, enemyShips, row, col);
+    gameRecord.recordShot(0, row, col, result);
+    playerShotOrder.push_back(BattleshipBoard::cellIndex(row, col));
     
-    if (hit) {
+    if (result.hit()) {
         updateStatusLabel();
-        if (isGameOver()) {
+        if (result.outcome == ShotResult::FleetDestroyed) {
             showGameResult(true);
             return;
         }
@@ -438,7 +486,24 @@ void BattleshipGame::onEnemyCellClicked(int row, int col)
 
 void BattleshipGame::aiMove()
 {
-    if (!gameActive || playerTurn) return;
+    if (!gameActive || playerTurn || networkMode) return;
+    
+    if (salvoMode) {
+        BoardMask shots = ai.makeSalvo(playerBoard, salvoSize(enemyBoard, playerBoard));
+        SalvoResult salvo = attackSalvo(playerBoard, playerView, playerShips, shots);
+        for (int shot = 0; shot < salvo.count; ++shot) {
+            int cell = salvo.cells[shot];
+            gameRecord.recordShot(1, cell / BOARD_SIZE, cell % BOARD_SIZE, salvo.results[shot]);
+        }
+        ai.updateSalvo(salvo);
+        if (salvo.fleetDestroyed()) {
+            showGameResult(false);
+            return;
+        }
+        playerTurn = true;
+        updateStatusLabel();
+        return;
+    }
     
     auto move = ai.makeMove(playerBoard);
     
@@ -452,39 +517,19 @@ void BattleshipGame::aiMove()
     int row = move.first;
     int col = move.second;
     
-    if (playerBoard[row][col] == 2 || playerBoard[row][col] == 3) {
+    if (playerBoard.isShot(row, col)) {
         aiTimer->start(100);
         return;
     }
     
-    bool hit = attackCell(playerBoard, playerCells, playerShips, row, col);
-    bool sunk = false;
-    
-    if (hit && playerBoard[row][col] == 2) {
-        for (auto& ship : playerShips) {
-            if (ship.hits >= ship.length && ship.hits > 0) {
-                bool isThisShip = false;
-                for (int i = 0; i < ship.length; ++i) {
-                    int shipRow = ship.horizontal ? ship.row : ship.row + i;
-                    int shipCol = ship.horizontal ? ship.col + i : ship.col;
-                    if (shipRow == row && shipCol == col) {
-                        isThisShip = true;
-                        break;
-                    }
-                }
-                if (isThisShip) {
-                    sunk = true;
-                    break;
-                }
-            }
-        }
-    }
+    ShotResult result = attackCell(playerBoard, playerView, playerShips, row, col);
+    gameRecord.recordShot(1, row, col, result);
     
-    ai.updateResult(row, col, hit, sunk);
+    ai.updateResult(row, col, result);
     
-    if (hit) {
+    if (result.hit()) {
         updateStatusLabel();
-        if (isGameOver()) {
+        if (result.outcome == ShotResult::FleetDestroyed) {
             showGameResult(false);
             return;
         }
@@ -497,40 +542,92 @@ void BattleshipGame::aiMove()
 
 
 
-bool BattleshipGame::attackCell(std::vector<std::vector<int>>& board,
-                               std::vector<std::vector<GridCell*>>& cells,
-                               std::vector<Ship>& ships, int row, int col)
+ShotResult BattleshipGame::attackCell(BattleshipBoard& board, BoardWidget* view,
+                                     std::vector<Ship>& ships, int row, int col)
 {
-    if (board[row][col] == 2 || board[row][col] == 3) {
-        return false;
+    ShotResult result = board.attack(row, col);
+    
+    switch (result.outcome) {
+        case ShotResult::AlreadyShot:
+            break;
+        case ShotResult::Miss:
+            view->setState(row, col, BoardWidget::Miss);
+            break;
+        default:
+            view->setState(row, col, BoardWidget::Hit);
+            ships[result.shipId].hits++;
+            if (result.sunk()) {
+                markSunkShip(view, ships[result.shipId]);
+            }
+            break;
     }
+    return result;
+}
 
-    if (board[row][col] > 0) {
-        int shipId = board[row][col];
-        board[row][col] = 2;
-        cells[row][col]->setState(GridCell::Hit);
-        
-        if (shipId >= 1 && shipId <= static_cast<int>(ships.size())) {
-            Ship& hitShip = ships[shipId - 1];
-            hitShip.hits++;
-            
-            if (hitShip.hits >= hitShip.length) {
-                markSunkShip(board, cells, hitShip);
-                return true;
-            }
+
+// Весь залп - одно обновление поля; update() виджета копит изменённые клетки,
+// и они перерисовываются за один проход
+SalvoResult BattleshipGame::attackSalvo(BattleshipBoard& board, BoardWidget* view,
+                                        std::vector<Ship>& ships, const BoardMask& shots)
+{
+    SalvoResult salvo = board.attack(shots);
+    for (int shot = 0; shot < salvo.count; ++shot) {
+        int cell = salvo.cells[shot];
+        const ShotResult& result = salvo.results[shot];
+        if (!result.hit()) {
+            view->setState(cell / BOARD_SIZE, cell % BOARD_SIZE, BoardWidget::Miss);
+            continue;
+        }
+        view->setState(cell / BOARD_SIZE, cell % BOARD_SIZE, BoardWidget::Hit);
+        ships[result.shipId].hits++;
+        if (result.sunk()) {
+            markSunkShip(view, ships[result.shipId]);
         }
-        return true;
-    } else {
-        board[row][col] = 3;
-        cells[row][col]->setState(GridCell::Miss);
-        return false;
     }
+    return salvo;
 }
 
+int BattleshipGame::salvoSize(const BattleshipBoard& shooter, const BattleshipBoard& target) const
+{
+    return std::min({shooter.shipsAfloat(), target.unshotCells().count(), SalvoResult::MAX_SHOTS});
+}
 
-void BattleshipGame::markSunkShip(std::vector<std::vector<int>>& board,
-                                 std::vector<std::vector<GridCell*>>& cells,
-                                 const Ship& ship)
+void BattleshipGame::aimSalvo(int row, int col)
+{
+    int cell = BattleshipBoard::cellIndex(row, col);
+    if (playerSalvo.test(cell)) {
+        playerSalvo.reset(cell);
+        enemyView->setState(row, col, BoardWidget::Empty);
+        updateStatusLabel();
+        return;
+    }
+    if (enemyView->getState(row, col) != BoardWidget::Empty) {
+        return;
+    }
+    playerSalvo.set(cell);
+    enemyView->setState(row, col, BoardWidget::Target);
+    if (playerSalvo.count() < salvoSize(playerBoard, enemyBoard)) {
+        updateStatusLabel();
+        return;
+    }
+    
+    SalvoResult salvo = attackSalvo(enemyBoard, enemyView, enemyShips, playerSalvo);
+    playerSalvo = BoardMask();
+    for (int shot = 0; shot < salvo.count; ++shot) {
+        int shotCell = salvo.cells[shot];
+        gameRecord.recordShot(0, shotCell / BOARD_SIZE, shotCell % BOARD_SIZE, salvo.results[shot]);
+        playerShotOrder.push_back(shotCell);
+    }
+    if (salvo.fleetDestroyed()) {
+        showGameResult(true);
+        return;
+    }
+    playerTurn = false;
+    updateStatusLabel();
+    aiTimer->start(1000);
+}
+
+void BattleshipGame::markSunkShip(BoardWidget* view, const Ship& ship)
 {
     for (int i = 0; i < ship.length; ++i) {
         int shipRow = ship.horizontal ? ship.row : ship.row + i;
@@ -538,7 +635,7 @@ void BattleshipGame::markSunkShip(std::vector<std::vector<int>>& board,
         
         if (shipRow >= 0 && shipRow < BOARD_SIZE &&
             shipCol >= 0 && shipCol < BOARD_SIZE) {
-            cells[shipRow][shipCol]->setState(GridCell::Sunk);
+            view->setState(shipRow, shipCol, BoardWidget::Sunk);
         }
     }
 }
@@ -546,28 +643,16 @@ void BattleshipGame::markSunkShip(std::vector<std::vector<int>>& board,
 
 bool BattleshipGame::isGameOver()
 {
-    bool playerDefeated = true;
-    for (auto& ship : playerShips) {
-        if (ship.hits < ship.length) {
-            playerDefeated = false;
-            break;
-        }
-    }
-    
-    bool enemyDefeated = true;
-    for (auto& ship : enemyShips) {
-        if (ship.hits < ship.length) {
-            enemyDefeated = false;
-            break;
-        }
-    }
-    
-    return playerDefeated || enemyDefeated;
+    return gameActive && (playerBoard.allSunk() || enemyBoard.allSunk());
 }
 
 void BattleshipGame::showGameResult(bool playerWon)
 {
     gameActive = false;
+    gameLog.append(gameRecord.finishGame());
+    shotHeatmap.recordGame(playerShotOrder);
+    shotHeatmap.save(heatmapPath());
+    placementPrior.recordFleet(playerBoard);
     
     QMessageBox msgBox;
     msgBox.setWindowTitle("Игра окончена");
@@ -594,17 +679,289 @@ void BattleshipGame::updateStatusLabel()
                                .arg(ship.name).arg(ship.length).arg(orientation));
         }
     } else if (gameActive) {
-        if (playerTurn) {
+        if (playerTurn && salvoMode) {
+            statusLabel->setText(QString("Ваш залп: отмечено %1 из %2 клеток")
+                                 .arg(playerSalvo.count()).arg(salvoSize(playerBoard, enemyBoard)));
+        } else if (playerTurn) {
             statusLabel->setText("Ваш ход - выберите клетку на поле противника");
         } else {
             statusLabel->setText("Ход противника...");
         }
+    } else if (networkMode && netMatch.currentPhase() < NetMatch::Playing) {
+        statusLabel->setText(netLink->isConnected() ? "Ожидание расстановки противника..."
+                                                    : "Ожидание подключения противника...");
     }
 }
 
 void BattleshipGame::restartGame()
 {
+    // По сети новая партия возможна только после окончания текущей
+    if (networkMode && netMatch.currentPhase() != NetMatch::Finished) {
+        leaveNetwork();
+    }
+    leaveReplay();
+    gameLog.append(gameRecord.finishGame());
+    aiTimer->stop();
+    initializeGame();
+}
+
+void BattleshipGame::openReplay()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Журнал партий", gameLogPath(),
+                                                "Журнал партий (*.bslog)");
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    // Открытие нового журнала освобождает отображение, на которое смотрит текущий повтор
+    if (replayMode || networkMode) {
+        leaveNetwork();
+        leaveReplay();
+        initializeGame();
+    }
+    
+    if (!replayLog.open(path) || replayLog.gameCount() == 0) {
+        QMessageBox::warning(this, "Повтор партии", "Не удалось прочитать журнал партий");
+        return;
+    }
+    
+    bool ok = false;
+    int count = static_cast<int>(replayLog.gameCount());
+    int number = QInputDialog::getInt(this, "Повтор партии",
+                                      QString("Номер партии (1-%1):").arg(count),
+                                      count, 1, count, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    aiTimer->stop();
+    gameLog.append(gameRecord.finishGame());
+    gameActive = false;
+    placementPhase = false;
+    clearHighlights();
+    advisor.cancel();
+    advisorTimer->stop();
+    advisorLabel->clear();
+    replayMode = true;
+    replayGameNumber = number;
+    replay.load(replayLog.game(number - 1));
+    
+    replaySlider->blockSignals(true);
+    replaySlider->setRange(0, replay.shotCount());
+    replaySlider->setValue(0);
+    replaySlider->blockSignals(false);
+    replayBar->show();
+    showReplayPosition();
+}
+
+void BattleshipGame::onReplaySliderMoved(int shot)
+{
+    if (!replayMode) {
+        return;
+    }
+    replay.seek(shot);
+    showReplayPosition();
+}
+
+void BattleshipGame::showReplayPosition()
+{
+    BoardWidget* views[2] = {playerView, enemyView};
+    for (int side = 0; side < 2; ++side) {
+        const BattleshipBoard& board = replay.board(side);
+        for (int row = 0; row < BOARD_SIZE; ++row) {
+            for (int col = 0; col < BOARD_SIZE; ++col) {
+                int shipId = board.shipAt(row, col);
+                BoardWidget::CellState state = BoardWidget::Empty;
+                if (shipId >= 0 && board.isSunk(shipId)) {
+                    state = BoardWidget::Sunk;
+                } else if (board.isShot(row, col)) {
+                    state = shipId >= 0 ? BoardWidget::Hit : BoardWidget::Miss;
+                } else if (shipId >= 0) {
+                    state = BoardWidget::Ship;
+                }
+                views[side]->setState(row, col, state);
+            }
+        }
+    }
+    
+    statusLabel->setText(QString("Повтор партии %1: выстрел %2 из %3")
+                         .arg(replayGameNumber).arg(replay.currentShot()).arg(replay.shotCount()));
+}
+
+void BattleshipGame::leaveReplay()
+{
+    if (!replayMode) {
+        return;
+    }
+    replayMode = false;
+    replayBar->hide();
+    replayLog.close();
+}
+
+void BattleshipGame::openNetworkGame()
+{
+    QStringList modes = {"Создать игру", "Подключиться"};
+    bool ok = false;
+    QString mode = QInputDialog::getItem(this, "Игра по сети", "Режим:", modes, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    bool host = mode == modes[0];
+    QString address;
+    int port = NetProtocol::DEFAULT_PORT;
+    if (host) {
+        port = QInputDialog::getInt(this, "Игра по сети", "Порт:", port, 1, 65535, 1, &ok);
+    } else {
+        address = QInputDialog::getText(this, "Игра по сети", "Адрес противника (хост:порт):",
+                                        QLineEdit::Normal,
+                                        QString("127.0.0.1:%1").arg(port), &ok);
+        int colon = address.lastIndexOf(':');
+        if (colon > 0) {
+            port = address.mid(colon + 1).toInt();
+            address = address.left(colon);
+        }
+    }
+    if (!ok || (!host && address.isEmpty())) {
+        return;
+    }
+    
+    leaveNetwork();
+    leaveReplay();
+    aiTimer->stop();
+    gameLog.append(gameRecord.finishGame());
+    
+    networkMode = true;
+    networkHost = host;
     initializeGame();
+    if (host) {
+        if (!netLink->listen(quint16(port))) {
+            return;
+        }
+    } else {
+        netLink->connectToHost(address, quint16(port));
+    }
+    enemyLabel->setText("Поле соперника");
+    updateStatusLabel();
+}
+
+void BattleshipGame::onNetworkConnected()
+{
+    netLink->send(NetProtocol::hello());
+    if (!placementPhase && netMatch.currentPhase() == NetMatch::Idle) {
+        startNetworkGame();
+    }
+    updateStatusLabel();
+}
+
+void BattleshipGame::startNetworkGame()
+{
+    // Ведущий стреляет первым
+    netMatch.start(playerBoard, networkHost);
+    sendNetwork();
+    gameActive = netMatch.currentPhase() == NetMatch::Playing;
+    playerTurn = netMatch.myTurn();
+}
+
+void BattleshipGame::onNetworkMessage(const NetProtocol::Message& message)
+{
+    NetMatch::Event event = netMatch.receive(message);
+    sendNetwork();
+    
+    switch (event.kind) {
+    case NetMatch::Event::OpponentReady:
+        gameActive = true;
+        playerTurn = netMatch.myTurn();
+        updateStatusLabel();
+        break;
+        
+    case NetMatch::Event::OpponentShot:
+        attackCell(playerBoard, playerView, playerShips, event.row, event.col);
+        playerTurn = netMatch.myTurn();
+        if (event.result.outcome == ShotResult::FleetDestroyed) {
+            showGameResult(false);
+        } else {
+            updateStatusLabel();
+        }
+        break;
+        
+    case NetMatch::Event::ShotAnswered:
+        if (!event.result.hit()) {
+            enemyView->setState(event.row, event.col, BoardWidget::Miss);
+        } else if (event.result.sunk()) {
+            for (BoardMask cells = event.sunkCells; cells.any();) {
+                int cell = cells.popFirst();
+                enemyView->setState(cell / BOARD_SIZE, cell % BOARD_SIZE, BoardWidget::Sunk);
+            }
+        } else {
+            enemyView->setState(event.row, event.col, BoardWidget::Hit);
+        }
+        playerTurn = netMatch.myTurn();
+        if (event.result.outcome == ShotResult::FleetDestroyed) {
+            showGameResult(true);
+        } else {
+            updateStatusLabel();
+        }
+        break;
+        
+    case NetMatch::Event::Verified: {
+        // Показываем уцелевшие корабли соперника
+        BoardMask afloat = netMatch.opponentBoard().occupiedCells() & ~netMatch.targetShots();
+        while (afloat.any()) {
+            int cell = afloat.popFirst();
+            enemyView->setState(cell / BOARD_SIZE, cell % BOARD_SIZE, BoardWidget::Ship);
+        }
+        statusLabel->setText("Партия окончена. \"Новая игра\" - реванш");
+        break;
+    }
+        
+    case NetMatch::Event::Cheated:
+        QMessageBox::warning(this, "Игра по сети",
+                             "Флот соперника не совпадает с заявленным в начале партии");
+        break;
+        
+    case NetMatch::Event::OpponentLeft:
+        onNetworkLost("Соперник вышел из игры");
+        break;
+        
+    case NetMatch::Event::ProtocolError:
+        onNetworkLost("Соперник прислал некорректное сообщение");
+        break;
+        
+    case NetMatch::Event::None:
+        break;
+    }
+}
+
+void BattleshipGame::onNetworkLost(const QString& reason)
+{
+    if (!networkMode) {
+        return;
+    }
+    bool finished = netMatch.currentPhase() == NetMatch::Finished;
+    leaveNetwork();
+    if (!finished) {
+        QMessageBox::warning(this, "Игра по сети", reason);
+    }
+    initializeGame();
+}
+
+void BattleshipGame::sendNetwork()
+{
+    netLink->send(netMatch.outbox());
+}
+
+void BattleshipGame::leaveNetwork()
+{
+    if (!networkMode) {
+        return;
+    }
+    netLink->send(NetProtocol::bye());
+    netLink->close();
+    netMatch = NetMatch();
+    networkMode = false;
+    gameActive = false;
+    enemyLabel->setText("Поле противника");
 }
 
 #include "battleshipgame.moc"
@@ -12,36 +12,20 @@
 #include <QMouseEvent>
 #include <QPainter>
 #include <QTimer>
+#include <QSlider>
+#include <QComboBox>
 #include <vector>
 #include <random>
-
-class GridCell : public QPushButton
-{
-    Q_OBJECT
-    
-public:
-    enum CellState { Empty, Ship, Hit, Miss, Sunk };
-    
-    GridCell(int row, int col, QWidget* parent = nullptr);
-    
-    void setState(CellState state);
-    CellState getState() const { return state; }
-    
-    int getRow() const { return row; }
-    int getCol() const { return col; }
-    
-protected:
-    void paintEvent(QPaintEvent* event) override;
-    void mousePressEvent(QMouseEvent* event) override;
-    
-signals:
-    void cellClicked(int row, int col);
-    void cellRightClicked(int row, int col);
-    
-private:
-    int row, col;
-    CellState state;
-};
+#include "battleshipboard.h"
+#include "boardwidget.h"
+#include "aiplayer.h"
+#include "fleetgenerator.h"
+#include "gamelog.h"
+#include "shotheatmap.h"
+#include "placementprior.h"
+#include "placementadvisor.h"
+#include "netlink.h"
+#include "netprotocol.h"
 
 struct Ship {
     int length;
@@ -54,26 +38,6 @@ struct Ship {
          horizontal(true), hits(0), name(n) {}
 };
 
-class AIPlayer
-{
-public:
-    AIPlayer();
-    std::pair<int, int> makeMove(const std::vector<std::vector<int>>& board);
-    void updateResult(int row, int col, bool hit, bool sunk);
-    
-private:
-    enum Mode { Random, Hunt, Target };
-    Mode currentMode;
-    std::vector<std::pair<int, int>> targetQueue;
-    std::pair<int, int> lastHit;
-    std::vector<std::pair<int, int>> directions;
-    int currentDirection;
-    std::mt19937 rng;
-    
-    void addAdjacentCells(int row, int col);
-    bool isValidCell(int row, int col, const std::vector<std::vector<int>>& board);
-};
-
 class BattleshipGame : public QMainWindow
 {
     Q_OBJECT
@@ -84,28 +48,41 @@ public:
 private slots:
     void onPlayerCellClicked(int row, int col);
     void onPlayerCellRightClicked(int row, int col);
+    void onPlayerCellHovered(int row, int col);
     void onEnemyCellClicked(int row, int col);
     void restartGame();
     void aiMove();
+    void openReplay();
+    void onReplaySliderMoved(int shot);
+    void openNetworkGame();
+    void onNetworkConnected();
+    void onNetworkMessage(const NetProtocol::Message& message);
+    void onNetworkLost(const QString& reason);
+    void updateAdvisorLabel();
     
 private:
     static const int BOARD_SIZE = 10;
     
     // UI элементы
     QWidget* centralWidget;
-    QGridLayout* playerGrid;
-    QGridLayout* enemyGrid;
+    BoardWidget* playerView;
+    BoardWidget* enemyView;
     QLabel* statusLabel;
+    QLabel* advisorLabel;
     QLabel* playerLabel;
     QLabel* enemyLabel;
     QPushButton* restartButton;
     QPushButton* menuButton;
+    QPushButton* replayButton;
+    QPushButton* networkButton;
+    QComboBox* placementCombo;
+    QComboBox* rulesCombo;
+    QWidget* replayBar;
+    QSlider* replaySlider;
     
     // Игровые поля
-    std::vector<std::vector<GridCell*>> playerCells;
-    std::vector<std::vector<GridCell*>> enemyCells;
-    std::vector<std::vector<int>> playerBoard;  // 0-пусто, 1-корабль, 2-попадание, 3-промах
-    std::vector<std::vector<int>> enemyBoard;
+    BattleshipBoard playerBoard;
+    BattleshipBoard enemyBoard;
     
     // Корабли
     std::vector<Ship> playerShips;
@@ -114,19 +91,49 @@ private:
     bool placementPhase;
     bool gameActive;
     bool playerTurn;
+    // Залп: за ход столько выстрелов, сколько у стреляющего кораблей на плаву
+    bool salvoMode;
+    BoardMask playerSalvo;
+    // Подсказка расстановки: допустимые начала текущего корабля пересчитываются
+    // только при постановке и повороте, движение мыши меняет лишь разницу клеток
+    BoardMask legalAnchors;
+    BoardMask shownAnchors;
+    BoardMask previewCells;
+    int hoverRow, hoverCol;
+    std::mt19937_64 rng;
     
     // ИИ
     AIPlayer ai;
     QTimer* aiTimer;
     
+    // Журнал партий и повтор
+    GameRecorder gameRecord;
+    GameLogWriter gameLog;
+    GameLogReader replayLog;
+    GameReplay replay;
+    bool replayMode;
+    int replayGameNumber;
+    
+    // Порядок выстрелов игрока для расстановки флота ИИ
+    ShotHeatmap shotHeatmap;
+    std::vector<int> playerShotOrder;
+    // Расстановки игрока - априорные веса положений для ИИ
+    PlacementPrior placementPrior;
+    
+    // Живучесть расстановки игрока, пересчитывается в фоне после каждого корабля
+    PlacementAdvisor advisor;
+    QTimer* advisorTimer;
+    
+    // Игра вдвоём по сети: флот противника неизвестен до конца партии
+    NetLink* netLink;
+    NetMatch netMatch;
+    bool networkMode;
+    bool networkHost;
+    
     void setupUI();
     void initializeGame();
     void createShips();
     void placeEnemyShips();
-    bool canPlaceShip(const std::vector<std::vector<int>>& board, int row, int col,
-                      int length, bool horizontal);
-    void placeShip(std::vector<std::vector<int>>& board, int row, int col,
-                   int length, bool horizontal, int shipId);
     bool isGameOver();
     void checkGameEnd();
     void showGameResult(bool playerWon);
@@ -135,12 +142,20 @@ private:
     void rotateCurrentShip();
     void highlightShipPlacement(int row, int col);
     void clearHighlights();
-    bool attackCell(std::vector<std::vector<int>>& board,
-                   std::vector<std::vector<GridCell*>>& cells,
-                   std::vector<Ship>& ships, int row, int col);
-    void markSunkShip(std::vector<std::vector<int>>& board,
-                     std::vector<std::vector<GridCell*>>& cells,
-                     const Ship& ship);
+    void updateLegalAnchors();
+    void restartAdvisor();
+    ShotResult attackCell(BattleshipBoard& board, BoardWidget* view,
+                          std::vector<Ship>& ships, int row, int col);
+    SalvoResult attackSalvo(BattleshipBoard& board, BoardWidget* view,
+                            std::vector<Ship>& ships, const BoardMask& shots);
+    int salvoSize(const BattleshipBoard& shooter, const BattleshipBoard& target) const;
+    void aimSalvo(int row, int col);
+    void markSunkShip(BoardWidget* view, const Ship& ship);
+    void showReplayPosition();
+    void leaveReplay();
+    void startNetworkGame();
+    void sendNetwork();
+    void leaveNetwork();
 };
 
 #endif
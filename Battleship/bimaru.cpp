@@ -0,0 +1,474 @@
+#include "bimaru.h"
+#include "boardmask.h"
+#include "sparseboard.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+int popcount(std::uint32_t bits)
+{
+    return BoardMask::popcount(bits);
+}
+
+int lowestBit(std::uint32_t bits)
+{
+    return BoardMask::ctz(bits);
+}
+
+std::uint32_t lineMask(int length)
+{
+    return length >= 32 ? ~std::uint32_t(0) : (std::uint32_t(1) << length) - 1;
+}
+
+}
+
+BimaruSolver::BimaruSolver(const BimaruPuzzle& puzzle)
+    : puzzle(puzzle), fullRow(lineMask(puzzle.size)), limit(1), nodes(0), nodeLimit(0),
+      stopped(false)
+{
+}
+
+int BimaruSolver::solve(int maxSolutions, std::uint64_t maxNodes)
+{
+    limit = std::max(1, maxSolutions);
+    nodeLimit = maxNodes;
+    nodes = 0;
+    stopped = false;
+    found.clear();
+
+    State state{};
+    const int size = puzzle.size;
+    for (int line = 0; line < size; ++line) {
+        state.rowLeft[line] = puzzle.rowCounts[line];
+        state.colLeft[line] = puzzle.colCounts[line];
+        state.blocked[line] = puzzle.givenWater[line];
+        state.must[line] = puzzle.givenShips[line];
+    }
+    for (int length : puzzle.fleet) {
+        if (length < 1 || length > size) {
+            return 0;
+        }
+        state.lengthLeft[length]++;
+        state.cellsLeft += length;
+    }
+    if (propagate(state)) {
+        search(state);
+    }
+    return static_cast<int>(found.size());
+}
+
+bool BimaruSolver::propagate(State& state) const
+{
+    const int size = puzzle.size;
+    Rows colFree{};  // свободные клетки столбца: бит row
+    for (bool changed = true; changed;) {
+        changed = false;
+        std::uint32_t fullCols = 0;
+        for (int line = 0; line < size; ++line) {
+            if (state.rowLeft[line] == 0) state.blocked[line] = fullRow;
+            if (state.colLeft[line] == 0) fullCols |= std::uint32_t(1) << line;
+        }
+
+        colFree.fill(0);
+        std::array<int, BimaruPuzzle::MAX_SIZE> colPending{};
+        for (int row = 0; row < size; ++row) {
+            state.blocked[row] |= fullCols;
+            std::uint32_t pending = state.must[row] & ~state.ships[row];
+            if (pending & state.blocked[row]) {
+                return false;
+            }
+            std::uint32_t free = ~state.blocked[row] & fullRow;
+            int freeCount = popcount(free);
+            if (freeCount < state.rowLeft[row] || popcount(pending) > state.rowLeft[row]) {
+                return false;
+            }
+            if (freeCount == state.rowLeft[row] && (free & ~state.must[row])) {
+                state.must[row] |= free;
+                changed = true;
+            }
+            for (std::uint32_t bits = free; bits; bits &= bits - 1) {
+                colFree[lowestBit(bits)] |= std::uint32_t(1) << row;
+            }
+            for (std::uint32_t bits = pending; bits; bits &= bits - 1) {
+                colPending[lowestBit(bits)]++;
+            }
+        }
+
+        for (int col = 0; col < size; ++col) {
+            int freeCount = popcount(colFree[col]);
+            if (freeCount < state.colLeft[col] || colPending[col] > state.colLeft[col]) {
+                return false;
+            }
+            if (freeCount != state.colLeft[col]) {
+                continue;
+            }
+            std::uint32_t bit = std::uint32_t(1) << col;
+            for (std::uint32_t rows = colFree[col]; rows; rows &= rows - 1) {
+                int row = lowestBit(rows);
+                if (!(state.must[row] & bit)) {
+                    state.must[row] |= bit;
+                    changed = true;
+                }
+            }
+        }
+
+        // По диагонали от клетки корабля всегда вода
+        for (int row = 0; row < size; ++row) {
+            std::uint32_t pending = state.must[row] & ~state.ships[row];
+            std::uint32_t diagonal = ((pending << 1) | (pending >> 1)) & fullRow;
+            for (int r = row - 1; r <= row + 1; r += 2) {
+                if (r >= 0 && r < size && (diagonal & ~state.blocked[r])) {
+                    state.blocked[r] |= diagonal;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    int longest = 0;
+    for (int length = size; length >= 1 && !longest; --length) {
+        if (state.lengthLeft[length]) longest = length;
+    }
+    auto hasRun = [](std::uint32_t bits, int length) {
+        for (int i = 1; i < length && bits; ++i) {
+            bits &= bits >> 1;
+        }
+        return bits != 0;
+    };
+
+    // Подряд идущие клетки корабля длиннее любого оставшегося корабля
+    Rows colPendingBits{};
+    for (int row = 0; row < size; ++row) {
+        std::uint32_t pending = state.must[row] & ~state.ships[row];
+        if (hasRun(pending, longest + 1)) {
+            return false;
+        }
+        for (std::uint32_t bits = pending; bits; bits &= bits - 1) {
+            colPendingBits[lowestBit(bits)] |= std::uint32_t(1) << row;
+        }
+    }
+    for (int col = 0; col < size; ++col) {
+        if (hasRun(colPendingBits[col], longest + 1)) {
+            return false;
+        }
+    }
+
+    // Самый длинный из оставшихся кораблей должен где-то помещаться
+    if (longest <= 1) {
+        return true;
+    }
+    for (int line = 0; line < size; ++line) {
+        if ((state.rowLeft[line] >= longest && hasRun(~state.blocked[line] & fullRow, longest)) ||
+            (state.colLeft[line] >= longest && hasRun(colFree[line], longest))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BimaruSolver::fits(const State& state, int row, int col, int length, bool horizontal) const
+{
+    const int size = puzzle.size;
+    if (row < 0 || col < 0) return false;
+    int placement = (horizontal ? 0 : size * size) + row * size + col;
+    if (placement < state.minPlacement[length]) return false;
+    if (horizontal) {
+        if (col + length > size || state.rowLeft[row] < length) return false;
+        if (state.blocked[row] & (lineMask(length) << col)) return false;
+        for (int i = 0; i < length; ++i) {
+            if (state.colLeft[col + i] < 1) return false;
+        }
+        return true;
+    }
+    if (row + length > size || state.colLeft[col] < length) return false;
+    std::uint32_t bit = std::uint32_t(1) << col;
+    for (int i = 0; i < length; ++i) {
+        if ((state.blocked[row + i] & bit) || state.rowLeft[row + i] < 1) return false;
+    }
+    return true;
+}
+
+void BimaruSolver::place(State& state, int row, int col, int length, bool horizontal) const
+{
+    const int size = puzzle.size;
+    std::uint32_t cells = horizontal ? lineMask(length) << col : std::uint32_t(1) << col;
+    std::uint32_t halo = (cells | (cells << 1) | (cells >> 1)) & fullRow;
+    int last = horizontal ? row : row + length - 1;
+    for (int r = std::max(0, row - 1); r <= std::min(size - 1, last + 1); ++r) {
+        state.blocked[r] |= halo;
+    }
+    for (int r = row; r <= last; ++r) {
+        state.ships[r] |= cells;
+        state.must[r] |= cells;
+        state.rowLeft[r] -= horizontal ? length : 1;
+    }
+    for (int c = col; c < col + (horizontal ? length : 1); ++c) {
+        state.colLeft[c] -= horizontal ? 1 : length;
+    }
+    state.lengthLeft[length]--;
+    state.cellsLeft -= length;
+}
+
+void BimaruSolver::search(const State& state)
+{
+    if (++nodes > nodeLimit && nodeLimit) {
+        stopped = true;
+        return;
+    }
+    const int size = puzzle.size;
+    if (state.cellsLeft == 0) {
+        for (int row = 0; row < size; ++row) {
+            if (state.must[row] & ~state.ships[row]) return;
+        }
+        found.push_back(state.ships);
+        return;
+    }
+
+    // Непокрытая клетка корабля с наименьшим числом способов её накрыть
+    int coverRow = -1, coverCol = -1, fewest = 0;
+    for (int row = 0; row < size; ++row) {
+        for (std::uint32_t pending = state.must[row] & ~state.ships[row]; pending; pending &= pending - 1) {
+            int col = lowestBit(pending);
+            int options = coverOptions(state, row, col);
+            if (options == 0) {
+                return;
+            }
+            if (coverRow == -1 || options < fewest) {
+                coverRow = row;
+                coverCol = col;
+                fewest = options;
+            }
+        }
+    }
+
+    // Иначе - все положения самого длинного из оставшихся кораблей
+    int longest = size;
+    while (state.lengthLeft[longest] == 0) {
+        longest--;
+    }
+    Rows starts[2];
+    legalStarts(state, longest, starts[0], starts[1]);
+    std::vector<int> candidates;
+    for (int orientation = 0; orientation < (longest == 1 ? 1 : 2); ++orientation) {
+        for (int row = 0; row < size; ++row) {
+            for (std::uint32_t bits = starts[orientation][row]; bits; bits &= bits - 1) {
+                int p = orientation * size * size + row * size + lowestBit(bits);
+                if (p >= state.minPlacement[longest]) {
+                    candidates.push_back(p);
+                }
+            }
+        }
+    }
+    if (coverRow != -1 && fewest <= static_cast<int>(candidates.size())) {
+        cover(state, coverRow, coverCol);
+        return;
+    }
+
+    for (int p : candidates) {
+        int row, col;
+        bool horizontal;
+        decodePlacement(p, row, col, horizontal);
+        State next = state;
+        place(next, row, col, longest, horizontal);
+        // Это первый из одинаковых кораблей, остальные стоят дальше по порядку
+        next.minPlacement[longest] = p + 1;
+        if (propagate(next)) {
+            search(next);
+        }
+        if (done()) {
+            return;
+        }
+    }
+}
+
+void BimaruSolver::legalStarts(const State& state, int length, Rows& horizontal, Rows& vertical) const
+{
+    // Бит col в строке row - корабль с началом (row, col) помещается, без учёта minPlacement
+    const int size = puzzle.size;
+    std::uint32_t colsWithRoom = 0, colsWithLength = 0;
+    for (int col = 0; col < size; ++col) {
+        if (state.colLeft[col] >= 1) colsWithRoom |= std::uint32_t(1) << col;
+        if (state.colLeft[col] >= length) colsWithLength |= std::uint32_t(1) << col;
+    }
+    for (int row = 0; row < size; ++row) {
+        std::uint32_t run = ~state.blocked[row] & colsWithRoom;
+        std::uint32_t down = ~state.blocked[row] & colsWithLength;
+        for (int i = 1; i < length; ++i) {
+            run &= run >> 1;
+            down &= row + i < size && state.rowLeft[row + i] >= 1 ? ~state.blocked[row + i] : 0;
+        }
+        horizontal[row] = state.rowLeft[row] >= length ? run & lineMask(size - length + 1) : 0;
+        vertical[row] = state.rowLeft[row] >= 1 ? down : 0;
+    }
+}
+
+void BimaruSolver::decodePlacement(int placement, int& row, int& col, bool& horizontal) const
+{
+    const int cells = puzzle.size * puzzle.size;
+    horizontal = placement < cells;
+    row = (placement % cells) / puzzle.size;
+    col = placement % puzzle.size;
+}
+
+int BimaruSolver::coverOptions(const State& state, int row, int col) const
+{
+    int options = 0;
+    for (int length = 1; length <= puzzle.size; ++length) {
+        if (state.lengthLeft[length] == 0) continue;
+        for (int shift = 0; shift < length; ++shift) {
+            options += fits(state, row, col - shift, length, true);
+            if (length > 1) options += fits(state, row - shift, col, length, false);
+        }
+    }
+    return options;
+}
+
+void BimaruSolver::cover(const State& state, int row, int col)
+{
+    // Клетку накрывает ровно один корабль: перебираем его длину, направление и сдвиг
+    for (int length = puzzle.size; length >= 1 && !done(); --length) {
+        if (state.lengthLeft[length] == 0) continue;
+        for (int orientation = 0; orientation < (length == 1 ? 1 : 2); ++orientation) {
+            bool horizontal = orientation == 0;
+            for (int shift = 0; shift < length && !done(); ++shift) {
+                int startRow = horizontal ? row : row - shift;
+                int startCol = horizontal ? col - shift : col;
+                if (!fits(state, startRow, startCol, length, horizontal)) {
+                    continue;
+                }
+                State next = state;
+                place(next, startRow, startCol, length, horizontal);
+                if (propagate(next)) {
+                    search(next);
+                }
+            }
+        }
+    }
+}
+
+std::vector<int> bimaruFleet(int size)
+{
+    static const int BASE[] = {4, 3, 3, 2, 2, 2, 1, 1, 1, 1};
+    int repeats = std::max(1, size * size / 100);
+    std::vector<int> fleet;
+    for (int i = 0; i < repeats; ++i) {
+        fleet.insert(fleet.end(), std::begin(BASE), std::end(BASE));
+    }
+    std::sort(fleet.begin(), fleet.end(), std::greater<int>());
+    return fleet;
+}
+
+bool generateBimaru(int size, const std::vector<int>& fleet, std::mt19937_64& rng,
+                    BimaruPuzzle& puzzle)
+{
+    if (size < 1 || size > BimaruPuzzle::MAX_SIZE) {
+        return false;
+    }
+    puzzle = BimaruPuzzle();
+    puzzle.size = size;
+    puzzle.fleet = fleet;
+    std::sort(puzzle.fleet.begin(), puzzle.fleet.end(), std::greater<int>());
+
+    SparseBoard board(size, size);
+    if (!board.placeFleet(puzzle.fleet, rng)) {
+        return false;
+    }
+    for (int shipId = 0; shipId < board.shipCount(); ++shipId) {
+        const SparseBoard::Ship& ship = board.ship(shipId);
+        for (int i = 0; i < ship.length; ++i) {
+            int row = ship.horizontal ? ship.row : ship.row + i;
+            int col = ship.horizontal ? ship.col + i : ship.col;
+            BimaruPuzzle::set(puzzle.solution, row, col);
+            puzzle.rowCounts[row]++;
+            puzzle.colCounts[col]++;
+        }
+    }
+
+    // Пока решений несколько, открываем клетку, где загаданное расходится с другим решением.
+    // Если проверка не уложилась в бюджет, открываем ещё не открытую клетку корабля:
+    // с ней перебор короче, а головоломка остаётся решаемой
+    const std::uint64_t budget = std::uint64_t(GENERATION_NODES_PER_SHIP) * puzzle.fleet.size();
+    for (;;) {
+        BimaruSolver solver(puzzle);
+        int count = solver.solve(2, budget);
+        if (solver.aborted() && count < 2) {
+            std::vector<int> hidden;
+            for (int row = 0; row < size; ++row) {
+                for (std::uint32_t bits = puzzle.solution[row] & ~puzzle.givenShips[row]; bits; bits &= bits - 1) {
+                    hidden.push_back(row * size + lowestBit(bits));
+                }
+            }
+            if (hidden.empty()) {
+                return true;
+            }
+            int cell = hidden[std::uniform_int_distribution<int>(0, int(hidden.size()) - 1)(rng)];
+            BimaruPuzzle::set(puzzle.givenShips, cell / size, cell % size);
+            continue;
+        }
+        if (count < 2) {
+            return true;
+        }
+        const auto& solutions = solver.solutions();
+        const BimaruPuzzle::Rows& other = solutions[0] == puzzle.solution ? solutions[1] : solutions[0];
+        std::vector<int> differing;
+        for (int row = 0; row < size; ++row) {
+            for (std::uint32_t bits = other[row] ^ puzzle.solution[row]; bits; bits &= bits - 1) {
+                differing.push_back(row * size + lowestBit(bits));
+            }
+        }
+        int cell = differing[std::uniform_int_distribution<int>(0, int(differing.size()) - 1)(rng)];
+        int row = cell / size, col = cell % size;
+        BimaruPuzzle::set(BimaruPuzzle::test(puzzle.solution, row, col) ? puzzle.givenShips
+                                                                         : puzzle.givenWater, row, col);
+    }
+}
+
+int bimaruHint(const BimaruPuzzle& puzzle, const BimaruPuzzle::Rows& ships,
+               const BimaruPuzzle::Rows& water, std::mt19937_64& rng)
+{
+    const int size = puzzle.size;
+    const std::uint32_t fullRow = lineMask(size);
+    std::vector<int> wrong;
+    std::array<int, BimaruPuzzle::MAX_SIZE> rowUnknown{};
+    std::array<int, BimaruPuzzle::MAX_SIZE> colUnknown{};
+    for (int row = 0; row < size; ++row) {
+        std::uint32_t bad = (ships[row] & ~puzzle.solution[row]) | (water[row] & puzzle.solution[row]);
+        for (; bad; bad &= bad - 1) {
+            wrong.push_back(row * size + lowestBit(bad));
+        }
+        std::uint32_t known = ships[row] | water[row] | puzzle.givenShips[row] | puzzle.givenWater[row];
+        for (std::uint32_t unknown = ~known & fullRow; unknown; unknown &= unknown - 1) {
+            rowUnknown[row]++;
+            colUnknown[lowestBit(unknown)]++;
+        }
+    }
+    if (!wrong.empty()) {
+        return wrong[std::uniform_int_distribution<int>(0, int(wrong.size()) - 1)(rng)];
+    }
+
+    // Чем меньше неизвестных в линии, тем проще вывести её клетки
+    int bestLine = -1, bestUnknown = 0;
+    for (int line = 0; line < 2 * size; ++line) {
+        int unknown = line < size ? rowUnknown[line] : colUnknown[line - size];
+        if (unknown > 0 && (bestLine == -1 || unknown < bestUnknown)) {
+            bestLine = line;
+            bestUnknown = unknown;
+        }
+    }
+    if (bestLine == -1) {
+        return -1;
+    }
+    int pick = std::uniform_int_distribution<int>(0, bestUnknown - 1)(rng);
+    for (int i = 0; i < size; ++i) {
+        int row = bestLine < size ? bestLine : i;
+        int col = bestLine < size ? i : bestLine - size;
+        bool known = BimaruPuzzle::test(ships, row, col) || BimaruPuzzle::test(water, row, col) ||
+                     BimaruPuzzle::test(puzzle.givenShips, row, col) ||
+                     BimaruPuzzle::test(puzzle.givenWater, row, col);
+        if (!known && pick-- == 0) {
+            return row * size + col;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,99 @@
+#ifndef BIMARU_H
+#define BIMARU_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Одиночная головоломка "Бимару": флот известен, у каждой строки и столбца
+// указано число клеток кораблей, часть клеток открыта. Клетки хранятся
+// строками битов: бит col строки row - клетка (row, col)
+struct BimaruPuzzle {
+    static constexpr int MAX_SIZE = 32;
+    using Rows = std::array<std::uint32_t, MAX_SIZE>;
+
+    int size = 0;
+    std::vector<int> fleet;  // длины по убыванию
+    std::array<int, MAX_SIZE> rowCounts{};
+    std::array<int, MAX_SIZE> colCounts{};
+    Rows givenShips{};
+    Rows givenWater{};
+    Rows solution{};
+
+    static bool test(const Rows& rows, int row, int col) { return (rows[row] >> col) & 1; }
+    static void set(Rows& rows, int row, int col) { rows[row] |= std::uint32_t(1) << col; }
+    static void reset(Rows& rows, int row, int col) { rows[row] &= ~(std::uint32_t(1) << col); }
+};
+
+// Поиск с распространением ограничений на строках битов: строка или столбец
+// с исчерпанным числом целиком становится водой, а если свободных клеток в линии
+// ровно столько, сколько осталось, все они становятся кораблём. Ветвление - по
+// положениям самого длинного из оставшихся кораблей либо, если так вариантов
+// меньше, по кораблю, накрывающему обязательную клетку
+class BimaruSolver
+{
+public:
+    using Rows = BimaruPuzzle::Rows;
+
+    explicit BimaruSolver(const BimaruPuzzle& puzzle);
+
+    // Число решений, но не больше limit; найденные решения сохраняются.
+    // maxNodes > 0 ограничивает перебор, тогда при aborted() ответ неполный
+    int solve(int limit, std::uint64_t maxNodes = 0);
+    const std::vector<Rows>& solutions() const { return found; }
+    std::uint64_t nodeCount() const { return nodes; }
+    bool aborted() const { return stopped; }
+
+private:
+    struct State {
+        Rows ships;    // поставленные корабли
+        Rows must;     // клетки, которые обязаны быть кораблём
+        Rows blocked;  // корабли, их соседи и известная вода
+        std::array<int, BimaruPuzzle::MAX_SIZE> rowLeft;
+        std::array<int, BimaruPuzzle::MAX_SIZE> colLeft;
+        std::array<int, BimaruPuzzle::MAX_SIZE + 1> lengthLeft;
+        // Положения с меньшим номером заняты не этими кораблями: одинаковые
+        // корабли не переставляются между собой
+        std::array<int, BimaruPuzzle::MAX_SIZE + 1> minPlacement;
+        int cellsLeft;
+    };
+
+    const BimaruPuzzle& puzzle;
+    std::uint32_t fullRow;
+    int limit;
+    std::uint64_t nodes;
+    std::uint64_t nodeLimit;
+    bool stopped;
+    std::vector<Rows> found;
+
+    bool propagate(State& state) const;
+    bool fits(const State& state, int row, int col, int length, bool horizontal) const;
+    void place(State& state, int row, int col, int length, bool horizontal) const;
+    void search(const State& state);
+    // Номер положения: сначала горизонтальные, затем вертикальные, по строкам
+    void legalStarts(const State& state, int length, Rows& horizontal, Rows& vertical) const;
+    void decodePlacement(int placement, int& row, int& col, bool& horizontal) const;
+    int coverOptions(const State& state, int row, int col) const;
+    void cover(const State& state, int row, int col);
+    bool done() const { return stopped || static_cast<int>(found.size()) >= limit; }
+};
+
+// Флот для поля size x size: на 10x10 классический 4, 3x2, 2x3, 1x4,
+// на больших полях повторяется примерно пропорционально площади
+std::vector<int> bimaruFleet(int size);
+
+// Бюджет одной проверки единственности при генерации, узлов перебора на корабль
+const int GENERATION_NODES_PER_SHIP = 10;
+
+// Случайная расстановка и открытые клетки, пока решение не станет единственным.
+// false, если флот не удалось расставить
+bool generateBimaru(int size, const std::vector<int>& fleet, std::mt19937_64& rng,
+                    BimaruPuzzle& puzzle);
+
+// Подсказка для отметок игрока: сначала ошибочная отметка, иначе неизвестная клетка
+// в самой заполненной линии. Номер клетки row * size + col или -1, если всё верно
+int bimaruHint(const BimaruPuzzle& puzzle, const BimaruPuzzle::Rows& ships,
+               const BimaruPuzzle::Rows& water, std::mt19937_64& rng);
+
+#endif
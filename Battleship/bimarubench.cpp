@@ -0,0 +1,95 @@
+// Генерация головоломок "Бимару" с проверкой единственности решения
+// для полей 10x10, 15x15 и 20x20 с флотом bimaruFleet(size)
+// battleship_bimaru [--sizes 10,15,20] [--puzzles N] [--seed S]
+
+#include "bimaru.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int countBits(const BimaruPuzzle::Rows& rows)
+{
+    int total = 0;
+    for (std::uint32_t bits : rows) {
+        for (; bits; bits &= bits - 1) total++;
+    }
+    return total;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> sizes = {10, 15, 20};
+    int puzzles = 100;
+    std::uint64_t seed = std::random_device{}();
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--sizes") && hasValue) {
+            sizes.clear();
+            std::stringstream list(argv[++i]);
+            std::string size;
+            while (std::getline(list, size, ',')) {
+                sizes.push_back(std::max(1, std::min(BimaruPuzzle::MAX_SIZE, std::atoi(size.c_str()))));
+            }
+        } else if (!std::strcmp(argv[i], "--puzzles") && hasValue) {
+            puzzles = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--sizes 10,15,20] [--puzzles N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("%6s %6s %8s %10s %10s %10s %10s\n", "size", "ships", "puzzles",
+                "mean ms", "max ms", "givens", "nodes");
+
+    std::mt19937_64 rng(seed);
+    for (int size : sizes) {
+        std::vector<int> fleet = bimaruFleet(size);
+        double totalMs = 0, maxMs = 0;
+        long long givens = 0;
+        std::uint64_t nodes = 0;
+        int generated = 0;
+        for (int i = 0; i < puzzles; ++i) {
+            BimaruPuzzle puzzle;
+            auto start = Clock::now();
+            if (!generateBimaru(size, fleet, rng, puzzle)) {
+                continue;
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            totalMs += ms;
+            maxMs = std::max(maxMs, ms);
+            givens += countBits(puzzle.givenShips) + countBits(puzzle.givenWater);
+
+            // Проверка: ровно одно решение, и это загаданная расстановка
+            BimaruSolver solver(puzzle);
+            if (solver.solve(2) != 1 || solver.solutions()[0] != puzzle.solution) {
+                std::fprintf(stderr, "size %d: puzzle %d has no unique solution\n", size, i);
+                return 1;
+            }
+            nodes += solver.nodeCount();
+            generated++;
+        }
+        if (generated == 0) {
+            std::printf("%6d %6zu %8d %10s\n", size, fleet.size(), 0, "-");
+            continue;
+        }
+        std::printf("%6d %6zu %8d %10.3f %10.3f %10.1f %10.0f\n", size, fleet.size(), generated,
+                    totalMs / generated, maxMs, double(givens) / generated, double(nodes) / generated);
+    }
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include "bimarugame.h"
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+BimaruGame::BimaruGame(int puzzleSize, QWidget* parent)
+    : QMainWindow(parent), size(puzzleSize), ships{}, water{}, rng(std::random_device{}()),
+      solved(false), hintsUsed(0)
+{
+    auto* central = new QWidget(this);
+    setCentralWidget(central);
+    auto* mainLayout = new QVBoxLayout(central);
+
+    statusLabel = new QLabel(this);
+    statusLabel->setAlignment(Qt::AlignCenter);
+    statusLabel->setStyleSheet("QLabel { font-size: 14px; font-weight: bold; }");
+    mainLayout->addWidget(statusLabel);
+
+    // Числа строк справа от поля, числа столбцов под ним - с тем же шагом, что и клетки
+    const int spacing = BoardWidget::CELL_PITCH - BoardWidget::CELL_SIZE;
+    auto* grid = new QGridLayout();
+    grid->setSpacing(4);
+    view = new BoardWidget(size, size, this);
+    connect(view, &BoardWidget::cellClicked, this, &BimaruGame::onCellClicked);
+    connect(view, &BoardWidget::cellRightClicked, this, &BimaruGame::onCellRightClicked);
+    grid->addWidget(view, 0, 0);
+
+    auto* rowsLayout = new QVBoxLayout();
+    auto* colsLayout = new QHBoxLayout();
+    rowsLayout->setSpacing(spacing);
+    colsLayout->setSpacing(spacing);
+    for (int line = 0; line < size; ++line) {
+        for (int axis = 0; axis < 2; ++axis) {
+            auto* label = new QLabel(this);
+            label->setFixedSize(BoardWidget::CELL_SIZE, BoardWidget::CELL_SIZE);
+            label->setAlignment(Qt::AlignCenter);
+            if (axis == 0) {
+                rowsLayout->addWidget(label);
+                rowLabels.push_back(label);
+            } else {
+                colsLayout->addWidget(label);
+                colLabels.push_back(label);
+            }
+        }
+    }
+    grid->addLayout(rowsLayout, 0, 1, Qt::AlignTop);
+    grid->addLayout(colsLayout, 1, 0, Qt::AlignLeft);
+    mainLayout->addLayout(grid);
+
+    auto* buttons = new QHBoxLayout();
+    auto* newButton = new QPushButton("Новая головоломка", this);
+    auto* hintButton = new QPushButton("Подсказка", this);
+    auto* solutionButton = new QPushButton("Решение", this);
+    connect(newButton, &QPushButton::clicked, this, &BimaruGame::newPuzzle);
+    connect(hintButton, &QPushButton::clicked, this, &BimaruGame::showHint);
+    connect(solutionButton, &QPushButton::clicked, this, &BimaruGame::showSolution);
+    buttons->addWidget(newButton);
+    buttons->addWidget(hintButton);
+    buttons->addWidget(solutionButton);
+    mainLayout->addLayout(buttons);
+
+    setWindowTitle(QString("Бимару %1x%1").arg(size));
+    newPuzzle();
+}
+
+void BimaruGame::newPuzzle()
+{
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = generateBimaru(size, bimaruFleet(size), rng, puzzle);
+    qint64 elapsed = timer.elapsed();
+
+    ships = BimaruPuzzle::Rows{};
+    water = BimaruPuzzle::Rows{};
+    solved = false;
+    hintsUsed = 0;
+    view->clear();
+    if (!ok) {
+        statusLabel->setText("Не удалось расставить флот");
+        return;
+    }
+
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            if (BimaruPuzzle::test(puzzle.givenShips, row, col)) {
+                view->setState(row, col, BoardWidget::Sunk);
+            } else if (BimaruPuzzle::test(puzzle.givenWater, row, col)) {
+                view->setState(row, col, BoardWidget::Miss);
+            }
+        }
+    }
+    updateCounts();
+    statusLabel->setText(QString("Кораблей: %1. Головоломка построена за %2 мс")
+                         .arg(puzzle.fleet.size()).arg(elapsed));
+}
+
+bool BimaruGame::isGiven(int row, int col) const
+{
+    return BimaruPuzzle::test(puzzle.givenShips, row, col) ||
+           BimaruPuzzle::test(puzzle.givenWater, row, col);
+}
+
+void BimaruGame::onCellClicked(int row, int col)
+{
+    if (solved || isGiven(row, col)) return;
+
+    // Пусто -> корабль -> вода -> пусто
+    BoardWidget::CellState state = view->getState(row, col);
+    setMark(row, col, state == BoardWidget::Empty ? BoardWidget::Ship
+                      : state == BoardWidget::Ship ? BoardWidget::Miss : BoardWidget::Empty);
+}
+
+void BimaruGame::onCellRightClicked(int row, int col)
+{
+    if (solved || isGiven(row, col)) return;
+
+    setMark(row, col, view->getState(row, col) == BoardWidget::Miss ? BoardWidget::Empty
+                                                                     : BoardWidget::Miss);
+}
+
+void BimaruGame::setMark(int row, int col, BoardWidget::CellState mark)
+{
+    BimaruPuzzle::reset(ships, row, col);
+    BimaruPuzzle::reset(water, row, col);
+    if (mark == BoardWidget::Ship) BimaruPuzzle::set(ships, row, col);
+    if (mark == BoardWidget::Miss) BimaruPuzzle::set(water, row, col);
+    view->setState(row, col, mark);
+    updateCounts();
+    checkSolved();
+}
+
+void BimaruGame::updateCounts()
+{
+    // Зелёный - в линии отмечено ровно столько, сколько нужно, красный - больше
+    std::vector<int> colMarked(size, 0);
+    for (int row = 0; row < size; ++row) {
+        int rowMarked = 0;
+        for (int col = 0; col < size; ++col) {
+            if (BimaruPuzzle::test(ships, row, col) || BimaruPuzzle::test(puzzle.givenShips, row, col)) {
+                rowMarked++;
+                colMarked[col]++;
+            }
+        }
+        int target = puzzle.rowCounts[row];
+        rowLabels[row]->setText(QString::number(target));
+        rowLabels[row]->setStyleSheet(rowMarked > target ? "color: red;"
+                                      : rowMarked == target ? "color: green;" : "");
+    }
+    for (int col = 0; col < size; ++col) {
+        int target = puzzle.colCounts[col];
+        colLabels[col]->setText(QString::number(target));
+        colLabels[col]->setStyleSheet(colMarked[col] > target ? "color: red;"
+                                      : colMarked[col] == target ? "color: green;" : "");
+    }
+}
+
+void BimaruGame::checkSolved()
+{
+    for (int row = 0; row < size; ++row) {
+        if ((ships[row] | puzzle.givenShips[row]) != puzzle.solution[row]) {
+            return;
+        }
+    }
+    solved = true;
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            if (BimaruPuzzle::test(puzzle.solution, row, col)) {
+                view->setState(row, col, BoardWidget::Sunk);
+            }
+        }
+    }
+    statusLabel->setText(QString("Решено! Подсказок: %1").arg(hintsUsed));
+    QMessageBox::information(this, "Бимару", "Головоломка решена!");
+}
+
+void BimaruGame::showHint()
+{
+    if (solved) return;
+
+    int cell = bimaruHint(puzzle, ships, water, rng);
+    if (cell < 0) {
+        return;
+    }
+    int row = cell / size;
+    int col = cell % size;
+    hintsUsed++;
+    statusLabel->setText(QString("Подсказка: строка %1, столбец %2 - %3")
+                         .arg(row + 1).arg(col + 1)
+                         .arg(BimaruPuzzle::test(puzzle.solution, row, col) ? "корабль" : "вода"));
+    setMark(row, col, BimaruPuzzle::test(puzzle.solution, row, col) ? BoardWidget::Ship
+                                                                    : BoardWidget::Miss);
+}
+
+void BimaruGame::showSolution()
+{
+    if (solved) return;
+
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            if (isGiven(row, col)) continue;
+            bool ship = BimaruPuzzle::test(puzzle.solution, row, col);
+            if (ship) BimaruPuzzle::set(ships, row, col);
+            else BimaruPuzzle::reset(ships, row, col);
+            view->setState(row, col, ship ? BoardWidget::Ship : BoardWidget::Empty);
+        }
+    }
+    water = BimaruPuzzle::Rows{};
+    solved = true;
+    updateCounts();
+    statusLabel->setText("Решение показано");
+}
@@ -0,0 +1,47 @@
+#ifndef BIMARUGAME_H
+#define BIMARUGAME_H
+
+#include <QMainWindow>
+#include <QLabel>
+#include <random>
+#include <vector>
+#include "bimaru.h"
+#include "boardwidget.h"
+
+// Головоломка "Бимару": у строк и столбцов указано число клеток кораблей,
+// игрок отмечает корабли (левая кнопка) и воду (правая кнопка)
+class BimaruGame : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit BimaruGame(int size, QWidget* parent = nullptr);
+
+private slots:
+    void newPuzzle();
+    void onCellClicked(int row, int col);
+    void onCellRightClicked(int row, int col);
+    void showHint();
+    void showSolution();
+
+private:
+    int size;
+    BimaruPuzzle puzzle;
+    BimaruPuzzle::Rows ships;  // отметки игрока
+    BimaruPuzzle::Rows water;
+    std::mt19937_64 rng;
+    bool solved;
+    int hintsUsed;
+
+    BoardWidget* view;
+    QLabel* statusLabel;
+    std::vector<QLabel*> rowLabels;
+    std::vector<QLabel*> colLabels;
+
+    bool isGiven(int row, int col) const;
+    void setMark(int row, int col, BoardWidget::CellState mark);
+    void updateCounts();
+    void checkSolved();
+};
+
+#endif
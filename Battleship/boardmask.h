@@ -0,0 +1,115 @@
+#ifndef BOARDMASK_H
+#define BOARDMASK_H
+
+#include <cstdint>
+
+// Битовая маска клеток поля 10x10: бит row * 10 + col, клетки 0-63 в lo, 64-99 в hi
+struct BoardMask
+{
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+
+    constexpr BoardMask() = default;
+    constexpr BoardMask(std::uint64_t low, std::uint64_t high) : lo(low), hi(high) {}
+
+    static constexpr BoardMask bit(int index)
+    {
+        return index < 64 ? BoardMask(std::uint64_t(1) << index, 0)
+                          : BoardMask(0, std::uint64_t(1) << (index - 64));
+    }
+
+    constexpr bool test(int index) const
+    {
+        return index < 64 ? (lo >> index) & 1 : (hi >> (index - 64)) & 1;
+    }
+
+    constexpr void set(int index)
+    {
+        if (index < 64) lo |= std::uint64_t(1) << index;
+        else hi |= std::uint64_t(1) << (index - 64);
+    }
+
+    constexpr void reset(int index)
+    {
+        if (index < 64) lo &= ~(std::uint64_t(1) << index);
+        else hi &= ~(std::uint64_t(1) << (index - 64));
+    }
+
+    constexpr bool any() const { return (lo | hi) != 0; }
+    constexpr bool none() const { return (lo | hi) == 0; }
+
+    constexpr int count() const { return popcount(lo) + popcount(hi); }
+
+    // Индекс младшего установленного бита, -1 для пустой маски
+    constexpr int first() const
+    {
+        return lo ? ctz(lo) : (hi ? 64 + ctz(hi) : -1);
+    }
+
+    constexpr int popFirst()
+    {
+        int index = first();
+        if (lo) lo &= lo - 1;
+        else hi &= hi - 1;
+        return index;
+    }
+
+    // Индекс n-го (с нуля) установленного бита
+    constexpr int nth(int n) const
+    {
+        int lowCount = popcount(lo);
+        std::uint64_t word = n < lowCount ? lo : hi;
+        int base = n < lowCount ? 0 : 64;
+        if (n >= lowCount) n -= lowCount;
+        for (; n > 0; --n) word &= word - 1;
+        return word ? base + ctz(word) : -1;
+    }
+
+    // Сдвиг к старшим индексам (shift > 0) или к младшим (shift < 0)
+    constexpr BoardMask shifted(int shift) const
+    {
+        if (shift == 0) return *this;
+        if (shift > 0) {
+            if (shift >= 64) return BoardMask(0, lo << (shift - 64));
+            return BoardMask(lo << shift, (hi << shift) | (lo >> (64 - shift)));
+        }
+        shift = -shift;
+        if (shift >= 64) return BoardMask(hi >> (shift - 64), 0);
+        return BoardMask((lo >> shift) | (hi << (64 - shift)), hi >> shift);
+    }
+
+    constexpr BoardMask operator&(const BoardMask& other) const { return {lo & other.lo, hi & other.hi}; }
+    constexpr BoardMask operator|(const BoardMask& other) const { return {lo | other.lo, hi | other.hi}; }
+    constexpr BoardMask operator^(const BoardMask& other) const { return {lo ^ other.lo, hi ^ other.hi}; }
+    constexpr BoardMask operator~() const { return {~lo, ~hi}; }
+    constexpr BoardMask& operator&=(const BoardMask& other) { lo &= other.lo; hi &= other.hi; return *this; }
+    constexpr BoardMask& operator|=(const BoardMask& other) { lo |= other.lo; hi |= other.hi; return *this; }
+    constexpr BoardMask& operator^=(const BoardMask& other) { lo ^= other.lo; hi ^= other.hi; return *this; }
+    constexpr bool operator==(const BoardMask& other) const { return lo == other.lo && hi == other.hi; }
+    constexpr bool operator!=(const BoardMask& other) const { return !(*this == other); }
+
+    static constexpr int popcount(std::uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return int((x * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    static constexpr int ctz(std::uint64_t x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+#else
+        int n = 0;
+        while (!(x & 1)) { x >>= 1; ++n; }
+        return n;
+#endif
+    }
+};
+
+#endif
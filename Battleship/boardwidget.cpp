@@ -0,0 +1,197 @@
+#include "boardwidget.h"
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <algorithm>
+
+BoardWidget::BoardWidget(int rows, int cols, QWidget* parent)
+    : QWidget(parent), rows(rows), cols(cols), states(rows * cols, Empty),
+      overlays(rows * cols, NoOverlay), hoverRow(-1), hoverCol(-1)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMouseTracking(true);
+    setFixedSize(sizeHint());
+    buildSprites();
+}
+
+QSize BoardWidget::sizeHint() const
+{
+    return QSize(cols * CELL_PITCH - 1, rows * CELL_PITCH - 1);
+}
+
+QRect BoardWidget::cellRect(int row, int col) const
+{
+    return QRect(col * CELL_PITCH, row * CELL_PITCH, CELL_SIZE, CELL_SIZE);
+}
+
+void BoardWidget::buildSprites()
+{
+    qreal ratio = devicePixelRatioF();
+    for (int state = 0; state < StateCount; ++state) {
+        QPixmap sprite(QSize(CELL_SIZE, CELL_SIZE) * ratio);
+        sprite.setDevicePixelRatio(ratio);
+        sprite.fill(QColor(173, 216, 230));
+        
+        QPainter painter(&sprite);
+        painter.setRenderHint(QPainter::Antialiasing);
+        QRect rect(0, 0, CELL_SIZE, CELL_SIZE);
+        
+        switch (state) {
+            case Ship:
+                painter.fillRect(rect, QColor(100, 100, 100));
+                break;
+            case Hit:
+                painter.fillRect(rect, QColor(255, 0, 0));
+                painter.setPen(QPen(Qt::white, 2));
+                painter.drawLine(5, 5, 25, 25);
+                painter.drawLine(25, 5, 5, 25);
+                break;
+            case Miss:
+                painter.fillRect(rect, QColor(0, 0, 255, 100));
+                painter.setPen(QPen(Qt::blue, 3));
+                painter.drawEllipse(10, 10, 10, 10);
+                break;
+            case Sunk:
+                painter.fillRect(rect, QColor(139, 0, 0));
+                break;
+            case Target:
+                painter.setPen(QPen(QColor(200, 0, 0), 2));
+                painter.drawEllipse(8, 8, 14, 14);
+                painter.drawLine(15, 3, 15, 27);
+                painter.drawLine(3, 15, 27, 15);
+                break;
+            default:
+                break;
+        }
+        
+        painter.setRenderHint(QPainter::Antialiasing, false);
+        painter.setPen(QPen(Qt::black, 1));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(rect.adjusted(0, 0, -1, -1));
+        
+        sprites[state] = sprite;
+    }
+    
+    // Полупрозрачные слои рисуются поверх спрайта клетки
+    for (int overlay = AnchorMark; overlay < OverlayCount; ++overlay) {
+        QPixmap sprite(QSize(CELL_SIZE, CELL_SIZE) * ratio);
+        sprite.setDevicePixelRatio(ratio);
+        sprite.fill(Qt::transparent);
+        
+        QPainter painter(&sprite);
+        painter.setRenderHint(QPainter::Antialiasing);
+        switch (overlay) {
+            case AnchorMark:
+                painter.setPen(Qt::NoPen);
+                painter.setBrush(QColor(0, 130, 0, 160));
+                painter.drawEllipse(12, 12, 6, 6);
+                break;
+            case PreviewValid:
+                painter.fillRect(2, 2, CELL_SIZE - 4, CELL_SIZE - 4, QColor(0, 160, 0, 110));
+                break;
+            case PreviewInvalid:
+                painter.fillRect(2, 2, CELL_SIZE - 4, CELL_SIZE - 4, QColor(220, 0, 0, 110));
+                break;
+            default:
+                break;
+        }
+        overlaySprites[overlay] = sprite;
+    }
+}
+
+void BoardWidget::setState(int row, int col, CellState state)
+{
+    CellState& current = states[row * cols + col];
+    if (current == state) {
+        return;
+    }
+    current = state;
+    update(cellRect(row, col));
+}
+
+void BoardWidget::setOverlay(int row, int col, Overlay overlay)
+{
+    Overlay& current = overlays[row * cols + col];
+    if (current == overlay) {
+        return;
+    }
+    current = overlay;
+    update(cellRect(row, col));
+}
+
+void BoardWidget::clear()
+{
+    std::fill(states.begin(), states.end(), Empty);
+    std::fill(overlays.begin(), overlays.end(), NoOverlay);
+    update();
+}
+
+void BoardWidget::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    painter.fillRect(dirty, palette().window());
+    
+    int firstRow = std::max(0, dirty.top() / CELL_PITCH);
+    int lastRow = std::min(rows - 1, dirty.bottom() / CELL_PITCH);
+    int firstCol = std::max(0, dirty.left() / CELL_PITCH);
+    int lastCol = std::min(cols - 1, dirty.right() / CELL_PITCH);
+    
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            QPoint topLeft = cellRect(row, col).topLeft();
+            painter.drawPixmap(topLeft, sprites[states[row * cols + col]]);
+            if (Overlay overlay = overlays[row * cols + col]) {
+                painter.drawPixmap(topLeft, overlaySprites[overlay]);
+            }
+        }
+    }
+}
+
+bool BoardWidget::cellAt(const QPoint& pos, int& row, int& col) const
+{
+    row = pos.y() / CELL_PITCH;
+    col = pos.x() / CELL_PITCH;
+    return pos.x() >= 0 && pos.y() >= 0 && row < rows && col < cols &&
+           cellRect(row, col).contains(pos);
+}
+
+void BoardWidget::mousePressEvent(QMouseEvent* event)
+{
+    int row, col;
+    if (!cellAt(event->position().toPoint(), row, col)) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    
+    if (event->button() == Qt::LeftButton) {
+        emit cellClicked(row, col);
+    } else if (event->button() == Qt::RightButton) {
+        emit cellRightClicked(row, col);
+    }
+}
+
+void BoardWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    int row, col;
+    // Над линией сетки остаёмся на прежней клетке, чтобы подсказка не мигала
+    if (cellAt(event->position().toPoint(), row, col)) {
+        setHover(row, col);
+    }
+}
+
+void BoardWidget::leaveEvent(QEvent* event)
+{
+    setHover(-1, -1);
+    QWidget::leaveEvent(event);
+}
+
+void BoardWidget::setHover(int row, int col)
+{
+    if (row == hoverRow && col == hoverCol) {
+        return;
+    }
+    hoverRow = row;
+    hoverCol = col;
+    emit cellHovered(row, col);
+}
@@ -0,0 +1,62 @@
+#ifndef BOARDWIDGET_H
+#define BOARDWIDGET_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <array>
+#include <vector>
+
+// Всё поле одним виджетом: клетки рисуются готовыми спрайтами,
+// перерисовываются только изменившиеся клетки
+class BoardWidget : public QWidget
+{
+    Q_OBJECT
+    
+public:
+    enum CellState { Empty, Ship, Hit, Miss, Sunk, Target, StateCount };
+    // Подсказки поверх клетки, состояние клетки не меняют
+    enum Overlay { NoOverlay, AnchorMark, PreviewValid, PreviewInvalid, OverlayCount };
+    
+    static const int CELL_SIZE = 30;
+    static const int CELL_PITCH = CELL_SIZE + 1;
+    
+    BoardWidget(int rows, int cols, QWidget* parent = nullptr);
+    
+    void setState(int row, int col, CellState state);
+    CellState getState(int row, int col) const { return states[row * cols + col]; }
+    void setOverlay(int row, int col, Overlay overlay);
+    Overlay getOverlay(int row, int col) const { return overlays[row * cols + col]; }
+    void clear();
+    
+    int rowCount() const { return rows; }
+    int columnCount() const { return cols; }
+    
+    QSize sizeHint() const override;
+    
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void leaveEvent(QEvent* event) override;
+    
+signals:
+    void cellClicked(int row, int col);
+    void cellRightClicked(int row, int col);
+    // Только при переходе на другую клетку; (-1, -1) - курсор ушёл с поля
+    void cellHovered(int row, int col);
+    
+private:
+    int rows, cols;
+    std::vector<CellState> states;
+    std::vector<Overlay> overlays;
+    std::array<QPixmap, StateCount> sprites;
+    std::array<QPixmap, OverlayCount> overlaySprites;
+    int hoverRow, hoverCol;
+    
+    void buildSprites();
+    QRect cellRect(int row, int col) const;
+    bool cellAt(const QPoint& pos, int& row, int& col) const;
+    void setHover(int row, int col);
+};
+
+#endif
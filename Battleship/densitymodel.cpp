@@ -0,0 +1,115 @@
+#include "densitymodel.h"
+#include "placementtable.h"
+#include "standardfleet.h"
+#include <algorithm>
+
+DensityModel::DensityModel()
+{
+    reset({});
+}
+
+void DensityModel::reset(const std::vector<int>& fleet)
+{
+    hits = BoardMask();
+    misses = BoardMask();
+    sunk = BoardMask();
+    sunkZone = BoardMask();
+    remaining = fleet;
+}
+
+void DensityModel::recordShot(int row, int col, bool hit, bool sunkShip)
+{
+    BoardMask cell = BoardMask::bit(BattleshipBoard::cellIndex(row, col));
+    if (!hit) {
+        misses |= cell;
+        return;
+    }
+    hits |= cell;
+    if (!sunkShip) {
+        return;
+    }
+
+    // Корабли не касаются друг друга, поэтому потопленный корабль -
+    // это связная группа непотопленных попаданий вокруг последнего выстрела
+    BoardMask open = openHits();
+    BoardMask ship = cell;
+    for (;;) {
+        BoardMask grown = BattleshipBoard::neighbourhood(ship) & open;
+        if (grown == ship) break;
+        ship = grown;
+    }
+    sunk |= ship;
+    sunkZone |= BattleshipBoard::neighbourhood(ship);
+
+    auto it = std::find(remaining.begin(), remaining.end(), ship.count());
+    if (it != remaining.end()) {
+        remaining.erase(it);
+    }
+}
+
+void DensityModel::compute(Grid& density) const
+{
+    BoardMask open = openHits();
+    BoardMask blocked = misses | sunkZone;
+    BoardMask unshot = BattleshipBoard::FULL_MASK & ~(hits | misses);
+
+    std::array<int, PlacementTable::MAX_LENGTH + 1> lengthCount{};
+    for (int length : remaining) {
+        if (length >= 1 && length <= PlacementTable::MAX_LENGTH) {
+            lengthCount[length]++;
+        }
+    }
+
+    // Первый ход против стандартного флота - готовая таблица
+    if (!prior && (hits | misses).none() && StandardFleet::matches(lengthCount)) {
+        density = StandardFleet::OPENING_DENSITY;
+        return;
+    }
+
+    density.fill(0);
+
+    for (int length = 1; length <= PlacementTable::MAX_LENGTH; ++length) {
+        if (lengthCount[length] == 0) continue;
+
+        for (const ShipPlacement& placement : PlacementTable::placements(length)) {
+            if ((placement.cells & blocked).any()) continue;
+            // Чужое попадание рядом с кораблём невозможно
+            if ((placement.halo & ~placement.cells & open).any()) continue;
+
+            BoardMask targets = placement.cells & unshot;
+            if (targets.none()) continue;
+
+            std::uint64_t weight = lengthCount[length];
+            if (prior) {
+                weight *= (*prior)[&placement - PlacementTable::all().begin()];
+            }
+            for (int covered = (placement.cells & open).count(); covered > 0; --covered) {
+                weight *= HIT_WEIGHT;
+            }
+            while (targets.any()) {
+                density[targets.popFirst()] += weight;
+            }
+        }
+    }
+}
+
+int DensityModel::bestCell(const Grid& density, const BoardMask& candidates, std::mt19937& rng)
+{
+    int best = -1;
+    std::uint64_t bestValue = 0;
+    int ties = 0;
+    BoardMask cells = candidates;
+    while (cells.any()) {
+        int cell = cells.popFirst();
+        if (density[cell] > bestValue) {
+            best = cell;
+            bestValue = density[cell];
+            ties = 1;
+        } else if (density[cell] == bestValue && bestValue > 0) {
+            if (std::uniform_int_distribution<>(0, ties++)(rng) == 0) {
+                best = cell;
+            }
+        }
+    }
+    return best;
+}
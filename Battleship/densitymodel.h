@@ -0,0 +1,50 @@
+#ifndef DENSITYMODEL_H
+#define DENSITYMODEL_H
+
+#include "battleshipboard.h"
+#include "placementtable.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Что ИИ знает о поле противника и сколько положений оставшихся кораблей
+// проходит через каждую клетку с учётом попаданий, промахов и потопленных кораблей
+class DensityModel
+{
+public:
+    using Grid = std::array<std::uint64_t, BattleshipBoard::CELL_COUNT>;
+
+    // Во сколько раз положение, накрывающее ещё не потопленное попадание, весомее пустого
+    static constexpr std::uint64_t HIT_WEIGHT = 24;
+
+    DensityModel();
+
+    void reset(const std::vector<int>& fleet);
+    void recordShot(int row, int col, bool hit, bool sunk);
+    // Множители положений по опыту прошлых партий; nullptr - все положения равновероятны
+    void setPrior(std::shared_ptr<const PlacementWeights> weights) { prior = std::move(weights); }
+
+    void compute(Grid& density) const;
+    // Клетка с наибольшей плотностью среди candidates (случайная среди равных), -1 если все нули
+    static int bestCell(const Grid& density, const BoardMask& candidates, std::mt19937& rng);
+
+    const BoardMask& hitCells() const { return hits; }
+    const BoardMask& missCells() const { return misses; }
+    const BoardMask& sunkCells() const { return sunk; }
+    const BoardMask& sunkNeighbourhood() const { return sunkZone; }
+    BoardMask unshotCells() const { return BattleshipBoard::FULL_MASK & ~(hits | misses); }
+    BoardMask openHits() const { return hits & ~sunk; }
+    const std::vector<int>& remainingShips() const { return remaining; }
+
+private:
+    BoardMask hits;
+    BoardMask misses;
+    BoardMask sunk;
+    BoardMask sunkZone;  // потопленные корабли вместе с соседними клетками
+    std::vector<int> remaining;
+    std::shared_ptr<const PlacementWeights> prior;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "fleetgenerator.h"
+#include <algorithm>
+#include <numeric>
+
+FleetGenerator::FleetGenerator(const std::vector<int>& fleet)
+    : valid(fleet.size() <= static_cast<size_t>(BattleshipBoard::MAX_SHIPS))
+{
+    for (int length : fleet) {
+        if (length < 1 || length > PlacementTable::MAX_LENGTH) valid = false;
+    }
+    if (!valid) {
+        return;
+    }
+    order.resize(fleet.size());
+    std::iota(order.begin(), order.end(), 0);
+    // Длинные корабли первыми, чтобы неудачная попытка обрывалась как можно раньше
+    std::stable_sort(order.begin(), order.end(),
+                     [&fleet](int a, int b) { return fleet[a] > fleet[b]; });
+    for (int index : order) {
+        ships.push_back(fleet[index]);
+    }
+}
+
+void FleetGenerator::setWeights(int length, const std::vector<double>& placementWeights)
+{
+    if (length < 1 || length > PlacementTable::MAX_LENGTH) {
+        return;
+    }
+    AliasTable& table = weights[length];
+    table.probability.clear();
+    table.alias.clear();
+    size_t count = PlacementTable::placements(length).size();
+    if (placementWeights.size() != count) {
+        return;
+    }
+
+    double total = std::accumulate(placementWeights.begin(), placementWeights.end(), 0.0);
+    if (total <= 0) {
+        return;
+    }
+
+    // Метод Уолкера: каждая ячейка делится между своим положением и одним "донором"
+    std::vector<double> scaled(count);
+    std::vector<std::uint32_t> small, large;
+    for (size_t i = 0; i < count; ++i) {
+        scaled[i] = placementWeights[i] * count / total;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+    }
+    table.probability.assign(count, UINT32_MAX);
+    table.alias.resize(count);
+    std::iota(table.alias.begin(), table.alias.end(), 0u);
+    while (!small.empty() && !large.empty()) {
+        std::uint32_t less = small.back();
+        small.pop_back();
+        std::uint32_t more = large.back();
+        table.probability[less] = static_cast<std::uint32_t>(scaled[less] * 4294967295.0);
+        table.alias[less] = more;
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+}
+
+std::uint32_t FleetGenerator::draw(std::mt19937_64& rng, int length) const
+{
+    const AliasTable& table = weights[length];
+    std::uint64_t random = rng();
+    std::uint64_t count = PlacementTable::placements(length).size();
+    std::uint32_t index = static_cast<std::uint32_t>(((random >> 32) * count) >> 32);
+    if (table.probability.empty()) {
+        return index;
+    }
+    return static_cast<std::uint32_t>(random) < table.probability[index] ? index : table.alias[index];
+}
+
+bool FleetGenerator::generate(std::mt19937_64& rng, Layout& layout, const BoardMask& reserved) const
+{
+    if (!valid) {
+        return false;
+    }
+    const int shipCount = static_cast<int>(ships.size());
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        BoardMask taken = reserved;
+        int index = 0;
+        for (; index < shipCount; ++index) {
+            const ShipPlacement& placement = PlacementTable::placements(ships[index])[draw(rng, ships[index])];
+            if ((placement.cells & taken).any()) break;
+            taken |= placement.halo;
+            layout[order[index]] = &placement;
+        }
+        if (index == shipCount) {
+            return true;
+        }
+    }
+    int budget = MAX_BACKTRACK_NODES;
+    return backtrack(rng, 0, reserved, layout, budget);
+}
+
+bool FleetGenerator::generate(std::mt19937_64& rng, BattleshipBoard& board) const
+{
+    Layout layout;
+    board.clear();
+    if (!generate(rng, layout)) {
+        return false;
+    }
+    for (size_t shipId = 0; shipId < ships.size(); ++shipId) {
+        const ShipPlacement& placement = *layout[shipId];
+        board.placeShip(static_cast<int>(shipId), placement.row, placement.col,
+                        placement.cells.count(), placement.horizontal);
+    }
+    return true;
+}
+
+bool FleetGenerator::backtrack(std::mt19937_64& rng, int index, const BoardMask& taken,
+                               Layout& layout, int& budget) const
+{
+    if (index == static_cast<int>(ships.size())) {
+        return true;
+    }
+    PlacementRange placements = PlacementTable::placements(ships[index]);
+    size_t start = draw(rng, ships[index]);
+    for (size_t i = 0; i < placements.size(); ++i) {
+        const ShipPlacement& placement = placements[(start + i) % placements.size()];
+        if (--budget < 0) {
+            return false;
+        }
+        if ((placement.cells & taken).any()) continue;
+        layout[order[index]] = &placement;
+        if (backtrack(rng, index + 1, taken | placement.halo, layout, budget)) {
+            return true;
+        }
+    }
+    return false;
+}
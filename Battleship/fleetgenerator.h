@@ -0,0 +1,61 @@
+#ifndef FLEETGENERATOR_H
+#define FLEETGENERATOR_H
+
+#include "battleshipboard.h"
+#include "placementtable.h"
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Случайная расстановка флота. Положение каждого корабля берётся независимо из таблицы
+// положений (равномерно или по весам через alias-таблицу), расстановка с касаниями
+// отбрасывается целиком - поэтому распределение точное: равномерное по всем допустимым
+// расстановкам или пропорциональное произведению весов. Число попыток ограничено,
+// после него расстановка ищется перебором с возвратом, тоже с ограничением: на тесном
+// поле (много занятых клеток в reserved) generate() может вернуть false, даже если
+// расстановка существует, зато время одного вызова всегда ограничено
+class FleetGenerator
+{
+public:
+    using Layout = std::array<const ShipPlacement*, BattleshipBoard::MAX_SHIPS>;
+
+    static constexpr int MAX_ATTEMPTS = 4096;
+    // Положений, которые перебор с возвратом пробует после неудачных попыток
+    static constexpr int MAX_BACKTRACK_NODES = 1 << 16;
+
+    // Флот больше MAX_SHIPS или с кораблём длины вне 1..MAX_LENGTH не принимается:
+    // такой генератор пуст, и generate() всегда возвращает false
+    explicit FleetGenerator(const std::vector<int>& fleet);
+
+    bool isValid() const { return valid; }
+
+    // Веса положений корабля длины length по индексам PlacementTable::placements(length);
+    // пустой вектор возвращает равномерный выбор
+    void setWeights(int length, const std::vector<double>& weights);
+
+    // false, если флот не помещается на поле или расстановка не найдена за
+    // MAX_BACKTRACK_NODES шагов перебора. reserved - клетки, которые корабли не могут
+    // занимать (например, уже стоящие корабли вместе с соседями)
+    bool generate(std::mt19937_64& rng, Layout& layout, const BoardMask& reserved = BoardMask()) const;
+    bool generate(std::mt19937_64& rng, BattleshipBoard& board) const;
+
+    const std::vector<int>& fleet() const { return ships; }
+
+private:
+    struct AliasTable {
+        std::vector<std::uint32_t> probability;  // порог в единицах 2^-32
+        std::vector<std::uint32_t> alias;
+    };
+
+    std::vector<int> ships;  // по убыванию длины
+    std::vector<int> order;  // исходный индекс корабля для каждой позиции в ships
+    std::array<AliasTable, PlacementTable::MAX_LENGTH + 1> weights;
+    bool valid;
+
+    std::uint32_t draw(std::mt19937_64& rng, int length) const;
+    bool backtrack(std::mt19937_64& rng, int index, const BoardMask& taken, Layout& layout,
+                   int& budget) const;
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "gamelog.h"
+#include <algorithm>
+
+namespace {
+
+// Запись из файла не доверяется: число кораблей, клетки и длины идут в BattleshipBoard
+// как индексы, поэтому всё проверяется до того, как запись попадёт в GameView
+bool isWellFormed(const std::uint8_t* record, std::size_t length)
+{
+    int ships0 = record[0], ships1 = record[1];
+    if (ships0 > BattleshipBoard::MAX_SHIPS || ships1 > BattleshipBoard::MAX_SHIPS ||
+        2 + 2 * std::size_t(ships0 + ships1) > length) {
+        return false;
+    }
+    const std::uint8_t* entry = record + 2;
+    for (int side = 0; side < 2; ++side) {
+        BoardMask taken;
+        for (int i = 0, count = side == 0 ? ships0 : ships1; i < count; ++i, entry += 2) {
+            int cell = entry[0] & 0x7F;
+            if (cell >= BattleshipBoard::CELL_COUNT) {
+                return false;
+            }
+            BoardMask ship = BattleshipBoard::shipMask(cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE,
+                                                       entry[1], (entry[0] & 0x80) != 0);
+            if (ship.none() || (ship & taken).any()) {
+                return false;
+            }
+            taken |= ship;
+        }
+    }
+    for (const std::uint8_t* end = record + length - 1; entry < end; entry += 2) {
+        int shipId = entry[1] >> 4;
+        if ((entry[0] & 0x7F) >= BattleshipBoard::CELL_COUNT ||
+            (entry[1] & 0x0F) > ShotResult::FleetDestroyed ||
+            (shipId >= BattleshipBoard::MAX_SHIPS && shipId != GameLog::NO_SHIP)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+namespace GameLog {
+
+ShipEntry GameView::ship(int side, int index) const
+{
+    const std::uint8_t* entry = data + 2 + 2 * (side == 0 ? index : data[0] + index);
+    int cell = entry[0] & 0x7F;
+    return {cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE, entry[1], (entry[0] & 0x80) != 0};
+}
+
+ShotEntry GameView::shot(int index) const
+{
+    const std::uint8_t* entry = data + shotsOffset() + 2 * index;
+    int cell = entry[0] & 0x7F;
+    int shipId = entry[1] >> 4;
+    return {entry[0] >> 7, cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE,
+            {static_cast<ShotResult::Outcome>(entry[1] & 0x0F), shipId == NO_SHIP ? -1 : shipId}};
+}
+
+void GameView::placeFleet(int side, BattleshipBoard& board) const
+{
+    board.clear();
+    for (int i = 0; i < shipCount(side); ++i) {
+        ShipEntry entry = ship(side, i);
+        board.placeShip(i, entry.row, entry.col, entry.length, entry.horizontal);
+    }
+}
+
+}
+
+bool GameLogWriter::open(const QString& path)
+{
+    close();
+    std::lock_guard<std::mutex> lock(mutex);
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    if (file.size() == 0) {
+        QByteArray header(GameLog::MAGIC, 4);
+        header.append(char(GameLog::VERSION));
+        header.append(char(BattleshipBoard::SIZE));
+        header.append(2, '\0');
+        file.write(header);
+    }
+    file.seek(file.size());
+    return true;
+}
+
+void GameLogWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.isOpen()) {
+        file.close();
+    }
+}
+
+void GameLogWriter::append(const QByteArray& records)
+{
+    if (records.isEmpty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.isOpen()) {
+        file.write(records);
+        file.flush();
+    }
+}
+
+void GameRecorder::appendFleet(const BattleshipBoard& board)
+{
+    for (int shipId = 0; shipId < board.shipCount(); ++shipId) {
+        BoardMask cells = board.shipCells(shipId);
+        int first = cells.first();
+        bool horizontal = cells.count() == 1 || cells.test(first + 1);
+        record.append(char(first | (horizontal ? 0x80 : 0)));
+        record.append(char(cells.count()));
+    }
+}
+
+void GameRecorder::beginGame(const BattleshipBoard& side0, const BattleshipBoard& side1)
+{
+    record.clear();
+    record.append(2, '\0');
+    record.append(char(side0.shipCount()));
+    record.append(char(side1.shipCount()));
+    appendFleet(side0);
+    appendFleet(side1);
+}
+
+void GameRecorder::recordShot(int side, int row, int col, const ShotResult& result)
+{
+    if (record.isEmpty()) {
+        return;
+    }
+    int shipId = result.shipId < 0 ? GameLog::NO_SHIP : result.shipId;
+    record.append(char(BattleshipBoard::cellIndex(row, col) | (side << 7)));
+    record.append(char(result.outcome | (shipId << 4)));
+}
+
+QByteArray GameRecorder::finishGame()
+{
+    if (record.isEmpty()) {
+        return record;
+    }
+    int size = record.size() - 2;
+    record[0] = char(size & 0xFF);
+    record[1] = char(size >> 8);
+    QByteArray finished;
+    finished.swap(record);
+    return finished;
+}
+
+GameLogReader::~GameLogReader()
+{
+    close();
+}
+
+bool GameLogReader::open(const QString& path)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < GameLog::HEADER_SIZE) {
+        close();
+        return false;
+    }
+    size = static_cast<std::size_t>(file.size());
+    data = file.map(0, file.size());
+    if (!data || !std::equal(GameLog::MAGIC, GameLog::MAGIC + 4, data) ||
+        data[4] != GameLog::VERSION || data[5] != BattleshipBoard::SIZE) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GameLogReader::close()
+{
+    if (data) {
+        file.unmap(const_cast<std::uint8_t*>(data));
+    }
+    data = nullptr;
+    size = 0;
+    offsets.clear();
+    indexed = false;
+    if (file.isOpen()) {
+        file.close();
+    }
+}
+
+bool GameLogReader::next(std::size_t& offset, GameLog::GameView& game) const
+{
+    if (offset < GameLog::HEADER_SIZE) {
+        offset = GameLog::HEADER_SIZE;
+    }
+    if (!data || offset + 2 > size) {
+        return false;
+    }
+    std::size_t length = data[offset] | (data[offset + 1] << 8);
+    if (length < 2 || offset + 2 + length > size || !isWellFormed(data + offset + 2, length)) {
+        return false;
+    }
+    game = GameLog::GameView(data + offset + 2, static_cast<int>(length));
+    offset += 2 + length;
+    return true;
+}
+
+void GameLogReader::buildIndex()
+{
+    offsets.clear();
+    std::size_t offset = 0;
+    GameLog::GameView game;
+    for (;;) {
+        std::size_t start = std::max<std::size_t>(offset, GameLog::HEADER_SIZE);
+        if (!next(offset, game)) break;
+        offsets.push_back(start);
+    }
+    indexed = true;
+}
+
+std::size_t GameLogReader::gameCount()
+{
+    if (!indexed) buildIndex();
+    return offsets.size();
+}
+
+GameLog::GameView GameLogReader::game(std::size_t index)
+{
+    if (index >= gameCount()) {
+        return GameLog::GameView();
+    }
+    std::size_t offset = offsets[index];
+    GameLog::GameView view;
+    next(offset, view);
+    return view;
+}
+
+void GameReplay::load(const GameLog::GameView& newGame)
+{
+    game = newGame;
+    position = -1;
+    seek(0);
+}
+
+void GameReplay::seek(int shot)
+{
+    shot = std::clamp(shot, 0, shotCount());
+    if (shot < position || position < 0) {
+        for (int side = 0; side < 2; ++side) {
+            if (game.isValid()) game.placeFleet(side, boards[side]);
+            else boards[side].clear();
+        }
+        position = 0;
+    }
+    for (; position < shot; ++position) {
+        GameLog::ShotEntry entry = game.shot(position);
+        boards[1 - entry.side].attack(entry.row, entry.col);
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include "battleshipboard.h"
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Двоичный журнал партий.
+// Заголовок файла: "BSLG", версия, размер поля, 2 байта резерва.
+// Партия: u16 длина остатка записи, u8 число кораблей каждой стороны,
+// корабли по 2 байта (клетка | горизонтально << 7, длина),
+// выстрелы по 2 байта (клетка | сторона << 7, исход | корабль << 4).
+// Выстрел стороны s приходится по флоту стороны 1 - s
+namespace GameLog {
+
+const char MAGIC[4] = {'B', 'S', 'L', 'G'};
+const std::uint8_t VERSION = 1;
+const int HEADER_SIZE = 8;
+const int NO_SHIP = 0x0F;
+
+struct ShipEntry {
+    int row, col, length;
+    bool horizontal;
+};
+
+struct ShotEntry {
+    int side;
+    int row, col;
+    ShotResult result;
+};
+
+// Партия прямо в отображённой памяти, без копирования и разбора
+class GameView
+{
+public:
+    GameView() : data(nullptr), size(0) {}
+    GameView(const std::uint8_t* data, int size) : data(data), size(size) {}
+
+    bool isValid() const { return data != nullptr; }
+    int shipCount(int side) const { return data[side]; }
+    ShipEntry ship(int side, int index) const;
+    int shotCount() const { return (size - shotsOffset()) / 2; }
+    ShotEntry shot(int index) const;
+
+    // Флот стороны на пустом поле
+    void placeFleet(int side, BattleshipBoard& board) const;
+
+private:
+    const std::uint8_t* data;  // запись без поля длины
+    int size;
+
+    int shotsOffset() const { return 2 + 2 * (data[0] + data[1]); }
+};
+
+}
+
+// Запись одной партии в памяти
+class GameRecorder
+{
+public:
+    void beginGame(const BattleshipBoard& side0, const BattleshipBoard& side1);
+    void recordShot(int side, int row, int col, const ShotResult& result);
+    bool inGame() const { return !record.isEmpty(); }
+    // Готовая запись партии (пустая, если партия не начата); после вызова записи нет
+    QByteArray finishGame();
+
+private:
+    QByteArray record;
+
+    void appendFleet(const BattleshipBoard& board);
+};
+
+class GameLogWriter
+{
+public:
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    // Дописывает одну или несколько готовых записей; можно вызывать из разных потоков
+    void append(const QByteArray& records);
+
+private:
+    QFile file;
+    std::mutex mutex;
+};
+
+class GameLogReader
+{
+public:
+    ~GameLogReader();
+
+    bool open(const QString& path);
+    void close();
+
+    // Последовательный проход: offset - позиция следующей записи, начиная с 0.
+    // Повреждённая запись (корабли или выстрелы за пределами поля и записи) обрывает проход
+    bool next(std::size_t& offset, GameLog::GameView& game) const;
+    // Произвольный доступ; индекс строится одним проходом по длинам записей
+    std::size_t gameCount();
+    GameLog::GameView game(std::size_t index);
+
+private:
+    QFile file;
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::vector<std::size_t> offsets;
+    bool indexed = false;
+
+    void buildIndex();
+};
+
+// Восстановление позиции партии после любого числа выстрелов
+class GameReplay
+{
+public:
+    void load(const GameLog::GameView& game);
+    void seek(int shot);
+    void step(int delta) { seek(position + delta); }
+
+    int currentShot() const { return position; }
+    int shotCount() const { return game.isValid() ? game.shotCount() : 0; }
+    const GameLog::GameView& view() const { return game; }
+    // Флот стороны side после currentShot() выстрелов
+    const BattleshipBoard& board(int side) const { return boards[side]; }
+
+private:
+    GameLog::GameView game;
+    BattleshipBoard boards[2];
+    int position = 0;
+};
+
+#endif
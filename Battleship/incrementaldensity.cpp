@@ -0,0 +1,231 @@
+#include "incrementaldensity.h"
+#include "standardfleet.h"
+
+namespace {
+
+// Обратные индексы от клетки к положениям в PlacementTable::all()
+struct PlacementIndex {
+    std::array<std::uint8_t, PlacementTable::TOTAL> lengths;
+    std::array<std::vector<int>, BattleshipBoard::CELL_COUNT> byCell;
+    std::array<std::vector<int>, BattleshipBoard::CELL_COUNT> byHalo;  // клетка рядом с положением
+
+    PlacementIndex()
+    {
+        for (int length = 1; length <= PlacementTable::MAX_LENGTH; ++length) {
+            int end = PlacementTable::firstIndex(length + 1);
+            for (int index = PlacementTable::firstIndex(length); index < end; ++index) {
+                const ShipPlacement& placement = PlacementTable::all()[index];
+                lengths[index] = static_cast<std::uint8_t>(length);
+                for (BoardMask cells = placement.cells; cells.any();) {
+                    byCell[cells.popFirst()].push_back(index);
+                }
+                for (BoardMask cells = placement.halo & ~placement.cells; cells.any();) {
+                    byHalo[cells.popFirst()].push_back(index);
+                }
+            }
+        }
+    }
+
+    static const PlacementIndex& instance()
+    {
+        static const PlacementIndex index;
+        return index;
+    }
+};
+
+}
+
+IncrementalDensity::IncrementalDensity()
+{
+    reset({});
+}
+
+void IncrementalDensity::reset(const std::vector<int>& fleet,
+                               std::shared_ptr<const PlacementWeights> weights)
+{
+    const PlacementIndex& index = PlacementIndex::instance();
+    prior = std::move(weights);
+    hits = BoardMask();
+    misses = BoardMask();
+    sunk = BoardMask();
+    grid.fill(0);
+    lengthCount.fill(0);
+    for (int length : fleet) {
+        if (length >= 1 && length <= PlacementTable::MAX_LENGTH) {
+            lengthCount[length]++;
+        }
+    }
+
+    states.assign(PlacementTable::TOTAL, {0, 0, false});
+    // Стандартный флот: веса равны числу кораблей длины, карта уже посчитана при компиляции
+    if (!prior && StandardFleet::matches(lengthCount)) {
+        for (size_t placement = 0; placement < states.size(); ++placement) {
+            std::uint64_t weight = lengthCount[index.lengths[placement]];
+            states[placement] = {weight, 0, weight > 0};
+        }
+        grid = StandardFleet::OPENING_DENSITY;
+        return;
+    }
+    for (size_t placement = 0; placement < states.size(); ++placement) {
+        if (lengthCount[index.lengths[placement]] > 0) {
+            states[placement].alive = true;
+            setWeight(static_cast<int>(placement), weightFor(static_cast<int>(placement)));
+        }
+    }
+}
+
+std::uint64_t IncrementalDensity::weightFor(int placement) const
+{
+    std::uint64_t weight = lengthCount[PlacementIndex::instance().lengths[placement]];
+    if (prior) {
+        weight *= (*prior)[placement];
+    }
+    for (int covered = states[placement].covered; covered > 0; --covered) {
+        weight *= DensityModel::HIT_WEIGHT;
+    }
+    return weight;
+}
+
+void IncrementalDensity::setWeight(int placement, std::uint64_t weight)
+{
+    PlacementState& state = states[placement];
+    if (state.weight == weight) {
+        return;
+    }
+    for (BoardMask cells = PlacementTable::all()[placement].cells; cells.any();) {
+        int cell = cells.popFirst();
+        grid[cell] = grid[cell] - state.weight + weight;
+    }
+    state.weight = weight;
+}
+
+void IncrementalDensity::kill(int placement)
+{
+    if (!states[placement].alive) {
+        return;
+    }
+    setWeight(placement, 0);
+    states[placement].alive = false;
+}
+
+void IncrementalDensity::recordShot(int row, int col, bool hit, bool sunkShip)
+{
+    const PlacementIndex& index = PlacementIndex::instance();
+    int cell = BattleshipBoard::cellIndex(row, col);
+
+    if (!hit) {
+        misses.set(cell);
+        for (int placement : index.byCell[cell]) {
+            kill(placement);
+        }
+        return;
+    }
+
+    hits.set(cell);
+    // Чужое попадание рядом с кораблём невозможно
+    for (int placement : index.byHalo[cell]) {
+        kill(placement);
+    }
+    for (int placement : index.byCell[cell]) {
+        if (!states[placement].alive) continue;
+        states[placement].covered++;
+        setWeight(placement, weightFor(placement));
+    }
+    if (!sunkShip) {
+        return;
+    }
+
+    BoardMask open = hits & ~sunk;
+    BoardMask ship = BoardMask::bit(cell);
+    for (;;) {
+        BoardMask grown = BattleshipBoard::neighbourhood(ship) & open;
+        if (grown == ship) break;
+        ship = grown;
+    }
+    sunk |= ship;
+    for (BoardMask zone = BattleshipBoard::neighbourhood(ship); zone.any();) {
+        for (int placement : index.byCell[zone.popFirst()]) {
+            kill(placement);
+        }
+    }
+
+    int length = ship.count();
+    if (length <= PlacementTable::MAX_LENGTH && lengthCount[length] > 0) {
+        lengthCount[length]--;
+        for (int placement = PlacementTable::firstIndex(length); placement < PlacementTable::firstIndex(length + 1); ++placement) {
+            if (lengthCount[length] == 0) kill(placement);
+            else if (states[placement].alive) setWeight(placement, weightFor(placement));
+        }
+    }
+}
+
+BackgroundTargeting::BackgroundTargeting()
+    : rng(std::random_device{}()), posted(0), applied(0), answer(-1), stopping(false)
+{
+    worker = std::thread(&BackgroundTargeting::run, this);
+}
+
+BackgroundTargeting::~BackgroundTargeting()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void BackgroundTargeting::post(Event event)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(std::move(event));
+        posted++;
+    }
+    wake.notify_one();
+}
+
+void BackgroundTargeting::reset(const std::vector<int>& fleet,
+                                std::shared_ptr<const PlacementWeights> weights)
+{
+    post({true, 0, 0, false, false, fleet, std::move(weights)});
+}
+
+void BackgroundTargeting::recordShot(int row, int col, bool hit, bool sunk)
+{
+    post({false, row, col, hit, sunk, {}, nullptr});
+}
+
+int BackgroundTargeting::bestMove()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this] { return applied == posted; });
+    return answer;
+}
+
+void BackgroundTargeting::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || !events.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        // Все накопившиеся события применяются подряд, ответ считается один раз
+        std::deque<Event> batch;
+        batch.swap(events);
+        lock.unlock();
+
+        for (const Event& event : batch) {
+            if (event.reset) model.reset(event.fleet, event.prior);
+            else model.recordShot(event.row, event.col, event.hit, event.sunk);
+        }
+        int best = DensityModel::bestCell(model.density(), model.unshotCells(), rng);
+
+        lock.lock();
+        applied += batch.size();
+        answer = best;
+        ready.notify_all();
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef INCREMENTALDENSITY_H
+#define INCREMENTALDENSITY_H
+
+#include "densitymodel.h"
+#include "placementtable.h"
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Та же плотность, что у DensityModel::compute, но после каждого выстрела
+// пересчитываются только положения, которые этот выстрел задел
+class IncrementalDensity
+{
+public:
+    IncrementalDensity();
+
+    void reset(const std::vector<int>& fleet,
+               std::shared_ptr<const PlacementWeights> weights = nullptr);
+    void recordShot(int row, int col, bool hit, bool sunk);
+
+    const DensityModel::Grid& density() const { return grid; }
+    BoardMask unshotCells() const { return BattleshipBoard::FULL_MASK & ~(hits | misses); }
+
+private:
+    struct PlacementState {
+        std::uint64_t weight;
+        std::uint8_t covered;  // сколько непотопленных попаданий накрывает
+        bool alive;
+    };
+
+    std::vector<PlacementState> states;  // по индексам общего списка положений
+    std::shared_ptr<const PlacementWeights> prior;
+    std::array<int, PlacementTable::MAX_LENGTH + 1> lengthCount;
+    DensityModel::Grid grid;
+    BoardMask hits;
+    BoardMask misses;
+    BoardMask sunk;
+
+    std::uint64_t weightFor(int placement) const;
+    void setWeight(int placement, std::uint64_t weight);
+    void kill(int placement);
+};
+
+// IncrementalDensity в отдельном потоке: результаты выстрелов обрабатываются,
+// пока игрок выбирает клетку, а ход ИИ только забирает готовый ответ
+class BackgroundTargeting
+{
+public:
+    BackgroundTargeting();
+    ~BackgroundTargeting();
+
+    BackgroundTargeting(const BackgroundTargeting&) = delete;
+    BackgroundTargeting& operator=(const BackgroundTargeting&) = delete;
+
+    void reset(const std::vector<int>& fleet,
+               std::shared_ptr<const PlacementWeights> weights = nullptr);
+    void recordShot(int row, int col, bool hit, bool sunk);
+    // Лучшая клетка после всех переданных выстрелов; ждёт, только если поток ещё не успел
+    int bestMove();
+
+private:
+    struct Event {
+        bool reset;
+        int row, col;
+        bool hit, sunk;
+        std::vector<int> fleet;
+        std::shared_ptr<const PlacementWeights> prior;
+    };
+
+    IncrementalDensity model;
+    std::mt19937 rng;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable ready;
+    std::deque<Event> events;
+    std::uint64_t posted;
+    std::uint64_t applied;
+    int answer;
+    bool stopping;
+
+    void post(Event event);
+    void run();
+};
+
+#endif
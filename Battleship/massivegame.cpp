@@ -0,0 +1,156 @@
+#include "massivegame.h"
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QScrollArea>
+#include <QVBoxLayout>
+
+MassiveGame::MassiveGame(int boardSize, QWidget* parent)
+    : QMainWindow(parent), size(boardSize), fleet(scaledFleet(boardSize)),
+      rng(std::random_device{}()), gameActive(false), playerTurn(true)
+{
+    auto* central = new QWidget(this);
+    setCentralWidget(central);
+    auto* mainLayout = new QVBoxLayout(central);
+
+    statusLabel = new QLabel(this);
+    statusLabel->setAlignment(Qt::AlignCenter);
+    statusLabel->setStyleSheet("QLabel { font-size: 14px; font-weight: bold; }");
+    mainLayout->addWidget(statusLabel);
+
+    auto* boardsLayout = new QHBoxLayout();
+    BoardWidget** views[2] = {&playerView, &enemyView};
+    const char* titles[2] = {"Ваше поле", "Поле противника"};
+    for (int side = 0; side < 2; ++side) {
+        auto* section = new QVBoxLayout();
+        auto* title = new QLabel(titles[side], this);
+        title->setAlignment(Qt::AlignCenter);
+        section->addWidget(title);
+
+        *views[side] = new BoardWidget(size, size, this);
+        auto* scroll = new QScrollArea(this);
+        scroll->setWidget(*views[side]);
+        scroll->setAlignment(Qt::AlignCenter);
+        section->addWidget(scroll);
+        boardsLayout->addLayout(section);
+    }
+    mainLayout->addLayout(boardsLayout);
+    connect(enemyView, &BoardWidget::cellClicked, this, &MassiveGame::onEnemyCellClicked);
+
+    auto* restartButton = new QPushButton("Новая игра", this);
+    connect(restartButton, &QPushButton::clicked, this, &MassiveGame::newGame);
+    mainLayout->addWidget(restartButton);
+
+    aiTimer = new QTimer(this);
+    aiTimer->setSingleShot(true);
+    connect(aiTimer, &QTimer::timeout, this, &MassiveGame::aiMove);
+
+    setWindowTitle(QString("Морской бой %1x%1").arg(size));
+    resize(1000, 700);
+    newGame();
+}
+
+void MassiveGame::newGame()
+{
+    aiTimer->stop();
+    playerView->clear();
+    enemyView->clear();
+    playerBoard.clear(size, size);
+    enemyBoard.clear(size, size);
+
+    gameActive = playerBoard.placeFleet(fleet, rng) && enemyBoard.placeFleet(fleet, rng);
+    playerTurn = true;
+    ai.reset(size, size, fleet, rng());
+
+    for (int shipId = 0; shipId < playerBoard.shipCount(); ++shipId) {
+        const SparseBoard::Ship& ship = playerBoard.ship(shipId);
+        for (int i = 0; i < ship.length; ++i) {
+            playerView->setState(ship.horizontal ? ship.row : ship.row + i,
+                                 ship.horizontal ? ship.col + i : ship.col, BoardWidget::Ship);
+        }
+    }
+    updateStatusLabel();
+}
+
+void MassiveGame::onEnemyCellClicked(int row, int col)
+{
+    if (!gameActive || !playerTurn || enemyBoard.isShot(row, col)) {
+        return;
+    }
+
+    ShotResult result = enemyBoard.attack(row, col);
+    showShot(enemyView, enemyBoard, row, col, result);
+    if (result.outcome == ShotResult::FleetDestroyed) {
+        finishGame(true);
+        return;
+    }
+    if (!result.hit()) {
+        playerTurn = false;
+        aiTimer->start(300);
+    }
+    updateStatusLabel();
+}
+
+void MassiveGame::aiMove()
+{
+    if (!gameActive || playerTurn) return;
+
+    auto move = ai.makeMove();
+    if (move.first == -1) {
+        playerTurn = true;
+        updateStatusLabel();
+        return;
+    }
+
+    ShotResult result = playerBoard.attack(move.first, move.second);
+    ai.updateResult(move.first, move.second, result);
+    showShot(playerView, playerBoard, move.first, move.second, result);
+    if (result.outcome == ShotResult::FleetDestroyed) {
+        finishGame(false);
+        return;
+    }
+    if (result.hit()) {
+        aiTimer->start(300);
+    } else {
+        playerTurn = true;
+    }
+    updateStatusLabel();
+}
+
+void MassiveGame::showShot(BoardWidget* view, const SparseBoard& board, int row, int col,
+                           const ShotResult& result)
+{
+    if (!result.hit()) {
+        view->setState(row, col, BoardWidget::Miss);
+        return;
+    }
+    if (!result.sunk()) {
+        view->setState(row, col, BoardWidget::Hit);
+        return;
+    }
+    const SparseBoard::Ship& ship = board.ship(result.shipId);
+    for (int i = 0; i < ship.length; ++i) {
+        view->setState(ship.horizontal ? ship.row : ship.row + i,
+                       ship.horizontal ? ship.col + i : ship.col, BoardWidget::Sunk);
+    }
+}
+
+void MassiveGame::finishGame(bool playerWon)
+{
+    gameActive = false;
+    updateStatusLabel();
+    QMessageBox::information(this, "Игра окончена",
+                             playerWon ? "Поздравляем! Вы победили!" : "Вы проиграли. Попробуйте еще раз!");
+}
+
+void MassiveGame::updateStatusLabel()
+{
+    if (!gameActive) {
+        statusLabel->setText(QString("Партия окончена. Кораблей на плаву: у вас %1, у противника %2")
+                             .arg(playerBoard.shipsAfloat()).arg(enemyBoard.shipsAfloat()));
+        return;
+    }
+    statusLabel->setText(QString("%1. Кораблей на плаву: у вас %2, у противника %3")
+                         .arg(playerTurn ? "Ваш ход" : "Ход противника")
+                         .arg(playerBoard.shipsAfloat()).arg(enemyBoard.shipsAfloat()));
+}
@@ -0,0 +1,48 @@
+#ifndef MASSIVEGAME_H
+#define MASSIVEGAME_H
+
+#include <QMainWindow>
+#include <QLabel>
+#include <QTimer>
+#include <random>
+#include <vector>
+#include "boardwidget.h"
+#include "sparseboard.h"
+#include "sparsehunter.h"
+
+// Партия на большом поле (до 1000x1000) с флотом scaledFleet: расстановка
+// обоих флотов случайная, поля прокручиваются, перерисовываются только изменённые клетки
+class MassiveGame : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit MassiveGame(int size, QWidget* parent = nullptr);
+
+private slots:
+    void onEnemyCellClicked(int row, int col);
+    void aiMove();
+    void newGame();
+
+private:
+    int size;
+    std::vector<int> fleet;
+    SparseBoard playerBoard;
+    SparseBoard enemyBoard;
+    SparseHunter ai;
+    std::mt19937_64 rng;
+    bool gameActive;
+    bool playerTurn;
+
+    BoardWidget* playerView;
+    BoardWidget* enemyView;
+    QLabel* statusLabel;
+    QTimer* aiTimer;
+
+    void showShot(BoardWidget* view, const SparseBoard& board, int row, int col,
+                  const ShotResult& result);
+    void finishGame(bool playerWon);
+    void updateStatusLabel();
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include "montecarlosampler.h"
+#include "placementtable.h"
+#include <algorithm>
+
+namespace {
+const int FLUSH_INTERVAL = 32;
+}
+
+MonteCarloSampler::MonteCarloSampler(int threads)
+    : threads(threads), stopping(false), samples(0)
+{
+    if (this->threads <= 0) {
+        this->threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (this->threads <= 0) this->threads = 1;
+    }
+    for (auto& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+MonteCarloSampler::~MonteCarloSampler()
+{
+    stop();
+}
+
+void MonteCarloSampler::start(const DensityModel& knowledge, std::uint64_t seed, int helpers)
+{
+    stop();
+    prepare(knowledge);
+
+    stopping = false;
+    if (helpers < 0) helpers = threads;
+    for (int i = 0; i < helpers; ++i) {
+        workers.emplace_back(&MonteCarloSampler::workerLoop, this,
+                             seed + (i + 1) * 0x9E3779B97F4A7C15ULL,
+                             std::chrono::steady_clock::time_point::max());
+    }
+}
+
+void MonteCarloSampler::prepare(const DensityModel& knowledge)
+{
+    for (auto& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    samples.store(0, std::memory_order_relaxed);
+
+    // Длинные корабли первыми: у них меньше всего вариантов
+    ships = knowledge.remainingShips();
+    std::sort(ships.begin(), ships.end(), std::greater<int>());
+    openHits = knowledge.openHits();
+    unshot = knowledge.unshotCells();
+
+    BoardMask blocked = knowledge.missCells() | knowledge.sunkNeighbourhood();
+    candidates.assign(ships.size(), {});
+    for (size_t i = 0; i < ships.size(); ++i) {
+        if (i > 0 && ships[i] == ships[i - 1]) {
+            candidates[i] = candidates[i - 1];
+            continue;
+        }
+        for (const ShipPlacement& placement : PlacementTable::placements(ships[i])) {
+            if ((placement.cells & blocked).any()) continue;
+            if ((placement.halo & ~placement.cells & openHits).any()) continue;
+            candidates[i].push_back({placement.cells, placement.halo});
+        }
+    }
+}
+
+void MonteCarloSampler::stop()
+{
+    stopping = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+int MonteCarloSampler::search(const DensityModel& knowledge, std::chrono::microseconds budget,
+                              std::uint64_t seed)
+{
+    // Вызывающий поток тоже набирает расстановки, поэтому вспомогательных на один меньше
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    start(knowledge, seed, threads - 1);
+    workerLoop(seed, deadline);
+    stop();
+    return bestMove();
+}
+
+int MonteCarloSampler::bestMove() const
+{
+    int best = -1;
+    std::uint32_t bestCount = 0;
+    BoardMask cells = unshot;
+    while (cells.any()) {
+        int cell = cells.popFirst();
+        std::uint32_t count = counts[cell].load(std::memory_order_relaxed);
+        if (count > bestCount) {
+            best = cell;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+void MonteCarloSampler::workerLoop(std::uint64_t seed, std::chrono::steady_clock::time_point deadline)
+{
+    std::mt19937_64 rng(seed);
+    std::array<std::uint32_t, BattleshipBoard::CELL_COUNT> local{};
+    int pending = 0;
+    int attempts = 0;
+
+    auto flush = [&] {
+        for (int cell = 0; cell < BattleshipBoard::CELL_COUNT; ++cell) {
+            if (local[cell]) {
+                counts[cell].fetch_add(local[cell], std::memory_order_relaxed);
+                local[cell] = 0;
+            }
+        }
+        samples.fetch_add(pending, std::memory_order_relaxed);
+        pending = 0;
+    };
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (++attempts % 16 == 0 && std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        BoardMask layout;
+        if (sampleLayout(rng, layout)) {
+            BoardMask targets = layout & unshot;
+            while (targets.any()) {
+                local[targets.popFirst()]++;
+            }
+            pending++;
+        }
+        if (pending == FLUSH_INTERVAL || attempts % (FLUSH_INTERVAL * 8) == 0) {
+            flush();
+        }
+    }
+    flush();
+}
+
+bool MonteCarloSampler::sampleLayout(std::mt19937_64& rng, BoardMask& layout) const
+{
+    const int shipCount = static_cast<int>(ships.size());
+    std::uint32_t placedShips = 0;
+    BoardMask taken;  // поставленные корабли вместе с соседними клетками
+    BoardMask uncovered = openHits;
+    layout = BoardMask();
+
+    // Случайное положение корабля ship, не касающееся уже поставленных; required - клетка,
+    // которую оно обязано накрыть. Выбор равномерный среди подходящих (reservoir sampling)
+    auto pick = [&](int ship, int required, const Candidate*& chosen, std::uint32_t& seen) {
+        for (const Candidate& candidate : candidates[ship]) {
+            if ((candidate.cells & taken).any()) continue;
+            if (required >= 0 && !candidate.cells.test(required)) continue;
+            if (std::uniform_int_distribution<std::uint32_t>(0, seen++)(rng) == 0) {
+                chosen = &candidate;
+            }
+        }
+    };
+
+    auto place = [&](int ship, const Candidate& candidate) {
+        placedShips |= 1u << ship;
+        taken |= candidate.halo;
+        layout |= candidate.cells;
+        uncovered &= ~candidate.cells;
+    };
+
+    // Сначала накрываем попадания, которые ещё не принадлежат потопленным кораблям
+    while (uncovered.any()) {
+        int hit = uncovered.first();
+        const Candidate* chosen = nullptr;
+        int chosenShip = -1;
+        std::uint32_t seen = 0;
+        for (int ship = 0; ship < shipCount; ++ship) {
+            if (placedShips & (1u << ship)) continue;
+            // Одинаковые корабли взаимозаменяемы, достаточно первого свободного
+            if (ship > 0 && ships[ship] == ships[ship - 1] && !(placedShips & (1u << (ship - 1)))) continue;
+            const Candidate* before = chosen;
+            pick(ship, hit, chosen, seen);
+            if (chosen != before) chosenShip = ship;
+        }
+        if (!chosen) return false;
+        place(chosenShip, *chosen);
+    }
+
+    for (int ship = 0; ship < shipCount; ++ship) {
+        if (placedShips & (1u << ship)) continue;
+        const Candidate* chosen = nullptr;
+        std::uint32_t seen = 0;
+        pick(ship, -1, chosen, seen);
+        if (!chosen) return false;
+        place(ship, *chosen);
+    }
+    return true;
+}
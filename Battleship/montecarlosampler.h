@@ -0,0 +1,58 @@
+#ifndef MONTECARLOSAMPLER_H
+#define MONTECARLOSAMPLER_H
+
+#include "densitymodel.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Выбор выстрела по случайным расстановкам флота, согласованным со всеми
+// результатами выстрелов. Расстановки набираются параллельно, у каждого потока
+// свой генератор; лучший на данный момент ход доступен в любой момент
+class MonteCarloSampler
+{
+public:
+    explicit MonteCarloSampler(int threads = 0);
+    ~MonteCarloSampler();
+
+    MonteCarloSampler(const MonteCarloSampler&) = delete;
+    MonteCarloSampler& operator=(const MonteCarloSampler&) = delete;
+
+    // Запускает фоновый набор расстановок; helpers - сколько потоков занять (по умолчанию все)
+    void start(const DensityModel& knowledge, std::uint64_t seed, int helpers = -1);
+    void stop();
+    // Ищет ход в течение budget и возвращает индекс клетки, -1 если ни одной расстановки не найдено
+    int search(const DensityModel& knowledge, std::chrono::microseconds budget, std::uint64_t seed);
+
+    int bestMove() const;
+    std::uint64_t sampleCount() const { return samples.load(std::memory_order_relaxed); }
+    int threadCount() const { return threads; }
+
+private:
+    struct Candidate {
+        BoardMask cells;
+        BoardMask halo;
+    };
+
+    int threads;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping;
+    std::array<std::atomic<std::uint32_t>, BattleshipBoard::CELL_COUNT> counts;
+    std::atomic<std::uint64_t> samples;
+
+    // Снимок знаний на время поиска
+    std::vector<int> ships;
+    std::vector<std::vector<Candidate>> candidates;  // допустимые положения по индексу корабля
+    BoardMask openHits;
+    BoardMask unshot;
+
+    void prepare(const DensityModel& knowledge);
+    void workerLoop(std::uint64_t seed, std::chrono::steady_clock::time_point deadline);
+    bool sampleLayout(std::mt19937_64& rng, BoardMask& layout) const;
+};
+
+#endif
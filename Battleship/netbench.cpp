@@ -0,0 +1,238 @@
+// Нагрузочный прогон сетевой игры: два бота играют друг с другом через NetLink.
+// battleship_netbench [--games N] [--seed S]           - второй бот в дочернем процессе по loopback
+// battleship_netbench --serve PORT [--games N]         - ждать противника
+// battleship_netbench --connect HOST PORT [--games N]  - подключиться к нему
+// Каждый бот печатает число выстрелов в секунду и время от Shot до Result
+
+#include "aiplayer.h"
+#include "battleshipboard.h"
+#include "fleetgenerator.h"
+#include "netlink.h"
+#include "netprotocol.h"
+#include "standardfleet.h"
+#include <QCoreApplication>
+#include <QProcess>
+#include <QStringList>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::vector<int> STANDARD_FLEET = StandardFleet::fleet();
+
+class BenchBot
+{
+public:
+    BenchBot(bool host, int games, std::uint64_t seed)
+        : host(host), gamesLeft(games), ai(AIPlayer::Density), generator(STANDARD_FLEET),
+          rng(seed), games(0), shots(0), cheated(0), failed(false)
+    {
+        ai.setSeed(static_cast<std::uint32_t>(seed));
+        QObject::connect(&link, &NetLink::connected, [this]() {
+            link.send(NetProtocol::hello());
+            start = Clock::now();
+            startGame();
+        });
+        QObject::connect(&link, &NetLink::messageReceived, [this](const NetProtocol::Message& message) {
+            onMessage(message);
+        });
+        QObject::connect(&link, &NetLink::failed, [this](const QString& reason) {
+            std::fprintf(stderr, "%s: %s\n", role(), qPrintable(reason));
+            finish(true);
+        });
+        QObject::connect(&link, &NetLink::disconnected, [this]() {
+            if (gamesLeft > 0) {
+                std::fprintf(stderr, "%s: connection closed\n", role());
+                finish(true);
+            }
+        });
+    }
+
+    NetLink link;
+
+    bool hasFailed() const { return failed; }
+
+    void report() const
+    {
+        double seconds = std::chrono::duration<double>(finished - start).count();
+        std::vector<std::int64_t> sorted = rtt;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double fraction) {
+            if (sorted.empty()) return 0.0;
+            size_t index = std::min(sorted.size() - 1, size_t(fraction * sorted.size()));
+            return sorted[index] / 1000.0;
+        };
+        double sum = 0;
+        for (std::int64_t ns : sorted) sum += ns;
+
+        std::printf("%s: games %d, shots %llu in %.2f s (%.0f shots/s), fleets not verified %d\n",
+                    role(), games, static_cast<unsigned long long>(shots), seconds,
+                    shots / std::max(seconds, 1e-9), cheated);
+        std::printf("%s: shot round trip mean %.1f us  p50 %.1f  p99 %.1f  max %.1f\n", role(),
+                    sorted.empty() ? 0.0 : sum / sorted.size() / 1000.0,
+                    percentile(0.50), percentile(0.99), percentile(1.0));
+        std::fflush(stdout);
+    }
+
+private:
+    bool host;
+    int gamesLeft;
+    AIPlayer ai;
+    NetMatch match;
+    BattleshipBoard target;  // без кораблей: ИИ нужно только множество обстрелянных клеток
+    FleetGenerator generator;
+    std::mt19937_64 rng;
+    int games;
+    std::uint64_t shots;
+    int cheated;
+    bool failed;
+    std::vector<std::int64_t> rtt;
+    Clock::time_point start;
+    Clock::time_point finished;
+    Clock::time_point shotSent;
+
+    const char* role() const { return host ? "host" : "guest"; }
+
+    void startGame()
+    {
+        BattleshipBoard fleet;
+        generator.generate(rng, fleet);
+        ai.reset(STANDARD_FLEET);
+        target.clear();
+        match.start(fleet, host);
+        play();
+    }
+
+    void play()
+    {
+        if (match.canShoot()) {
+            auto move = ai.makeMove(target);
+            match.shoot(move.first, move.second);
+            shotSent = Clock::now();
+        }
+        link.send(match.outbox());
+    }
+
+    void onMessage(const NetProtocol::Message& message)
+    {
+        NetMatch::Event event = match.receive(message);
+        switch (event.kind) {
+        case NetMatch::Event::ShotAnswered:
+            rtt.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              Clock::now() - shotSent).count());
+            shots++;
+            target.attack(event.row, event.col);
+            ai.updateResult(event.row, event.col, event.result);
+            break;
+        case NetMatch::Event::Verified:
+        case NetMatch::Event::Cheated:
+            cheated += event.kind == NetMatch::Event::Cheated;
+            games++;
+            link.send(match.outbox());
+            if (--gamesLeft == 0) {
+                finish(false);
+                return;
+            }
+            startGame();
+            return;
+        case NetMatch::Event::ProtocolError:
+            std::fprintf(stderr, "%s: protocol error\n", role());
+            finish(true);
+            return;
+        case NetMatch::Event::OpponentLeft:
+            std::fprintf(stderr, "%s: opponent left\n", role());
+            finish(true);
+            return;
+        default:
+            break;
+        }
+        play();
+    }
+
+    void finish(bool error)
+    {
+        failed = failed || error;
+        finished = Clock::now();
+        gamesLeft = 0;
+        QMetaObject::invokeMethod(QCoreApplication::instance(), &QCoreApplication::quit,
+                                  Qt::QueuedConnection);
+    }
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int games = 1000;
+    std::uint64_t seed = std::random_device{}();
+    bool serve = false;
+    QString connectHost;
+    quint16 port = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--games") && hasValue) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--serve") && hasValue) {
+            serve = true;
+            port = quint16(std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--connect") && i + 2 < argc) {
+            connectHost = QString::fromLocal8Bit(argv[++i]);
+            port = quint16(std::atoi(argv[++i]));
+        } else {
+            std::fprintf(stderr, "usage: %s [--games N] [--seed S] [--serve PORT | --connect HOST PORT]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    bool host = connectHost.isEmpty();
+    BenchBot bot(host, games, seed);
+    QProcess guest;
+
+    if (!host) {
+        bot.link.connectToHost(connectHost, port);
+    } else {
+        if (!bot.link.listen(port)) {
+            return 1;
+        }
+        if (serve) {
+            std::printf("host: waiting on port %u\n", unsigned(bot.link.serverPort()));
+            std::fflush(stdout);
+        } else {
+            QObject::connect(&guest, &QProcess::finished, [&bot]() {
+                if (!bot.link.isConnected()) {
+                    QCoreApplication::exit(1);
+                }
+            });
+            guest.setProcessChannelMode(QProcess::ForwardedChannels);
+            guest.start(QCoreApplication::applicationFilePath(),
+                        {"--connect", "127.0.0.1", QString::number(bot.link.serverPort()),
+                         "--games", QString::number(games),
+                         "--seed", QString::number(seed ^ 0x9E3779B97F4A7C15ULL)});
+        }
+    }
+
+    int status = app.exec();
+    if (status != 0) {
+        std::fprintf(stderr, "host: guest process did not connect\n");
+        return status;
+    }
+    bot.report();
+    if (guest.state() != QProcess::NotRunning) {
+        guest.waitForFinished(10000);
+    }
+    return bot.hasFailed() ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+#include "netlink.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+
+NetLink::NetLink(QObject* parent)
+    : QObject(parent), server(nullptr), socket(nullptr), flushQueued(false)
+{
+}
+
+NetLink::~NetLink()
+{
+    close();
+}
+
+bool NetLink::listen(quint16 port)
+{
+    close();
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &NetLink::acceptConnection);
+    if (!server->listen(QHostAddress::Any, port)) {
+        emit failed(server->errorString());
+        return false;
+    }
+    return true;
+}
+
+quint16 NetLink::serverPort() const
+{
+    return server ? server->serverPort() : 0;
+}
+
+void NetLink::connectToHost(const QString& host, quint16 port)
+{
+    close();
+    auto* connection = new QTcpSocket(this);
+    attach(connection);
+    connection->connectToHost(host, port);
+}
+
+void NetLink::close()
+{
+    if (socket) {
+        socket->disconnect(this);
+        // Последние сообщения (например, Bye) уходят без ожидания ответа
+        if (isConnected() && !outgoing.isEmpty()) {
+            socket->write(outgoing);
+            socket->flush();
+        }
+        socket->disconnectFromHost();
+        socket->deleteLater();
+        socket = nullptr;
+    }
+    if (server) {
+        server->close();
+        server->deleteLater();
+        server = nullptr;
+    }
+    outgoing.clear();
+    incoming.clear();
+}
+
+bool NetLink::isConnected() const
+{
+    return socket && socket->state() == QAbstractSocket::ConnectedState;
+}
+
+void NetLink::send(const NetProtocol::Message& message)
+{
+    int offset = outgoing.size();
+    outgoing.resize(offset + NetProtocol::MESSAGE_SIZE);
+    NetProtocol::encode(message, reinterpret_cast<std::uint8_t*>(outgoing.data() + offset));
+    if (!flushQueued) {
+        flushQueued = true;
+        QMetaObject::invokeMethod(this, &NetLink::flush, Qt::QueuedConnection);
+    }
+}
+
+void NetLink::send(std::vector<NetProtocol::Message>& messages)
+{
+    for (const NetProtocol::Message& message : messages) {
+        send(message);
+    }
+    messages.clear();
+}
+
+void NetLink::acceptConnection()
+{
+    QTcpSocket* connection = server->nextPendingConnection();
+    if (socket) {
+        connection->abort();
+        connection->deleteLater();
+        return;
+    }
+    // Второй игрок не нужен - дальше сервер не слушает
+    server->close();
+    attach(connection);
+    connection->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    emit connected();
+}
+
+void NetLink::attach(QTcpSocket* connection)
+{
+    socket = connection;
+    connect(socket, &QTcpSocket::connected, this, [this]() {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        flush();
+        emit connected();
+    });
+    connect(socket, &QTcpSocket::readyRead, this, &NetLink::readMessages);
+    connect(socket, &QTcpSocket::disconnected, this, &NetLink::disconnected);
+    connect(socket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError error) {
+        if (error != QAbstractSocket::RemoteHostClosedError) {
+            emit failed(socket->errorString());
+        }
+    });
+}
+
+void NetLink::readMessages()
+{
+    incoming.append(socket->readAll());
+
+    const auto* data = reinterpret_cast<const std::uint8_t*>(incoming.constData());
+    int offset = 0;
+    NetProtocol::Message message;
+    while (socket && incoming.size() - offset >= NetProtocol::MESSAGE_SIZE) {
+        if (!NetProtocol::decode(data + offset, message)) {
+            emit failed("Неизвестное сообщение");
+            return;
+        }
+        offset += NetProtocol::MESSAGE_SIZE;
+        emit messageReceived(message);
+    }
+    if (socket) {
+        incoming.remove(0, offset);
+    }
+}
+
+void NetLink::flush()
+{
+    flushQueued = false;
+    // До подключения сообщения ждут в буфере
+    if (isConnected() && !outgoing.isEmpty()) {
+        socket->write(outgoing);
+        outgoing.clear();
+    }
+}
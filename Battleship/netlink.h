@@ -0,0 +1,54 @@
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include "netprotocol.h"
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+class QTcpServer;
+class QTcpSocket;
+
+// TCP-соединение с противником. Всё асинхронно через цикл событий: send() только
+// дописывает сообщение в буфер, и всё, что накопилось за один проход цикла,
+// уходит одной записью без задержки Нейгла
+class NetLink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetLink(QObject* parent = nullptr);
+    ~NetLink();
+
+    // Ждёт одно входящее подключение; port 0 - любой свободный
+    bool listen(quint16 port);
+    quint16 serverPort() const;
+    void connectToHost(const QString& host, quint16 port);
+    void close();
+    bool isConnected() const;
+
+    void send(const NetProtocol::Message& message);
+    void send(std::vector<NetProtocol::Message>& messages);  // забирает все сообщения
+
+signals:
+    void connected();
+    void messageReceived(const NetProtocol::Message& message);
+    void disconnected();
+    void failed(const QString& reason);
+
+private slots:
+    void acceptConnection();
+    void readMessages();
+    void flush();
+
+private:
+    QTcpServer* server;
+    QTcpSocket* socket;
+    QByteArray outgoing;
+    QByteArray incoming;
+    bool flushQueued;
+
+    void attach(QTcpSocket* connection);
+};
+
+#endif
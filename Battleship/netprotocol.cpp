@@ -0,0 +1,279 @@
+#include "netprotocol.h"
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+
+namespace NetProtocol {
+
+namespace {
+
+void appendUint64(QByteArray& bytes, std::uint64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        bytes.append(char(value >> (8 * i)));
+    }
+}
+
+}
+
+void encode(const Message& message, std::uint8_t* out)
+{
+    out[0] = message.type;
+    out[1] = message.row;
+    out[2] = message.col;
+    out[3] = message.param;
+    for (int i = 0; i < 8; ++i) {
+        out[4 + i] = std::uint8_t(message.value >> (8 * i));
+    }
+}
+
+bool decode(const std::uint8_t* in, Message& message)
+{
+    if (in[0] < Hello || in[0] > Bye) {
+        return false;
+    }
+    message.type = in[0];
+    message.row = in[1];
+    message.col = in[2];
+    message.param = in[3];
+    message.value = 0;
+    for (int i = 0; i < 8; ++i) {
+        message.value |= std::uint64_t(in[4 + i]) << (8 * i);
+    }
+    return true;
+}
+
+Message hello()
+{
+    return {Hello, 0, 0, 0, VERSION};
+}
+
+Message bye()
+{
+    return {Bye, 0, 0, 0, 0};
+}
+
+std::uint64_t fleetCommitment(const BattleshipBoard& board, const Salt& salt)
+{
+    QByteArray bytes;
+    appendUint64(bytes, salt[0]);
+    appendUint64(bytes, salt[1]);
+    bytes.append(char(board.shipCount()));
+    for (int shipId = 0; shipId < board.shipCount(); ++shipId) {
+        const BoardMask& ship = board.shipCells(shipId);
+        appendUint64(bytes, ship.lo);
+        appendUint64(bytes, ship.hi);
+    }
+    QByteArray digest = QCryptographicHash::hash(bytes, QCryptographicHash::Sha256);
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= std::uint64_t(std::uint8_t(digest[i])) << (8 * i);
+    }
+    return value;
+}
+
+Salt randomSalt()
+{
+    QRandomGenerator* source = QRandomGenerator::system();
+    return {source->generate64(), source->generate64()};
+}
+
+}
+
+using namespace NetProtocol;
+
+NetMatch::NetMatch()
+    : phase(Idle), salt{}, opponentSalt{}, opponentSaltHalf(false), opponentCommitment(0),
+      opponentCommitted(false),
+      turn(false), shotPending(false), pendingCell(-1), victory(false), revealValid(true),
+      revealedIds(0), revealedLengths{}
+{
+}
+
+void NetMatch::start(const BattleshipBoard& fleet, bool movesFirst)
+{
+    own = fleet;
+    revealed.clear();
+    targetHits = BoardMask();
+    targetMisses = BoardMask();
+    salt = randomSalt();
+    opponentSalt = {};
+    opponentSaltHalf = false;
+    turn = movesFirst;
+    shotPending = false;
+    pendingCell = -1;
+    victory = false;
+    revealValid = true;
+    revealedIds = 0;
+    revealedLengths.fill(0);
+
+    send(Commit, 0, 0, 0, fleetCommitment(own, salt));
+    phase = Committed;
+    if (opponentCommitted) {
+        opponentCommitted = false;
+        phase = Playing;
+    }
+}
+
+bool NetMatch::shoot(int row, int col)
+{
+    if (!canShoot() || !BattleshipBoard::inBounds(row, col) ||
+        targetShots().test(BattleshipBoard::cellIndex(row, col))) {
+        return false;
+    }
+    shotPending = true;
+    pendingCell = BattleshipBoard::cellIndex(row, col);
+    send(Shot, row, col, 0, 0);
+    return true;
+}
+
+NetMatch::Event NetMatch::receive(const Message& message)
+{
+    Event event;
+    event.row = message.row;
+    event.col = message.col;
+
+    switch (message.type) {
+    case Hello:
+        return message.value == VERSION ? event : error();
+
+    case Commit:
+        if (phase == Playing || phase == Revealing || opponentCommitted) {
+            return error();
+        }
+        opponentCommitment = message.value;
+        if (phase == Committed) {
+            phase = Playing;
+            event.kind = Event::OpponentReady;
+        } else {
+            opponentCommitted = true;
+        }
+        return event;
+
+    case Shot: {
+        if (phase != Playing || turn || !BattleshipBoard::inBounds(message.row, message.col) ||
+            own.isShot(message.row, message.col)) {
+            return error();
+        }
+        event.kind = Event::OpponentShot;
+        event.result = own.attack(message.row, message.col);
+        int shipBits = event.result.shipId < 0 ? 0x0F : event.result.shipId;
+        send(Result, message.row, message.col, event.result.outcome | shipBits << 4, 0);
+        if (!event.result.hit()) {
+            turn = true;
+        } else if (event.result.outcome == ShotResult::FleetDestroyed) {
+            finishGame(false);
+        }
+        return event;
+    }
+
+    case Result: {
+        int outcome = message.param & 0x0F;
+        int shipBits = message.param >> 4;
+        if (!shotPending || !BattleshipBoard::inBounds(message.row, message.col) ||
+            BattleshipBoard::cellIndex(message.row, message.col) != pendingCell ||
+            outcome < ShotResult::Miss || outcome > ShotResult::FleetDestroyed) {
+            return error();
+        }
+        shotPending = false;
+        event.kind = Event::ShotAnswered;
+        event.result = {ShotResult::Outcome(outcome), shipBits == 0x0F ? -1 : shipBits};
+        if (!event.result.hit()) {
+            targetMisses.set(pendingCell);
+            turn = false;
+            return event;
+        }
+        targetHits.set(pendingCell);
+        if (event.result.sunk()) {
+            // Корабли не касаются друг друга, поэтому связная группа попаданий и есть корабль
+            BoardMask ship = BoardMask::bit(pendingCell);
+            for (BoardMask grown = ship; ; ship = grown) {
+                grown = BattleshipBoard::neighbourhood(ship) & targetHits;
+                if (grown == ship) break;
+            }
+            event.sunkCells = ship;
+        }
+        if (event.result.outcome == ShotResult::FleetDestroyed) {
+            finishGame(true);
+        }
+        return event;
+    }
+
+    case Reveal: {
+        if (phase != Revealing) {
+            return error();
+        }
+        int length = message.param & 0x7F;
+        bool horizontal = message.param >> 7;
+        // Повторный номер заменил бы корабль, оставив его клетки занятыми
+        if (message.value < BattleshipBoard::MAX_SHIPS && !(revealedIds >> message.value & 1) &&
+            revealed.canPlaceShip(message.row, message.col, length, horizontal)) {
+            revealed.placeShip(int(message.value), message.row, message.col, length, horizontal);
+            revealedIds |= 1 << message.value;
+            revealedLengths[length]++;
+        } else {
+            revealValid = false;
+        }
+        return event;
+    }
+
+    case RevealSalt:
+        if (phase != Revealing || opponentSaltHalf) {
+            return error();
+        }
+        opponentSalt[0] = message.value;
+        opponentSaltHalf = true;
+        return event;
+
+    case RevealDone: {
+        if (phase != Revealing || !opponentSaltHalf) {
+            return error();
+        }
+        phase = Finished;
+        opponentSalt[1] = message.value;
+        const BoardMask& ships = revealed.occupiedCells();
+        // Без сверки с флотом пустая или неполная расстановка честно отвечала бы
+        // промахами и проходила проверку хеша
+        bool consistent = revealValid && StandardFleet::matches(revealedLengths) &&
+                          fleetCommitment(revealed, opponentSalt) == opponentCommitment &&
+                          (targetMisses & ships).none() && (targetHits & ~ships).none() &&
+                          (!victory || (ships & ~targetHits).none());
+        event.kind = consistent ? Event::Verified : Event::Cheated;
+        return event;
+    }
+
+    case Bye:
+        event.kind = Event::OpponentLeft;
+        return event;
+    }
+    return error();
+}
+
+void NetMatch::send(std::uint8_t type, int row, int col, int param, std::uint64_t value)
+{
+    pending.push_back({type, std::uint8_t(row), std::uint8_t(col), std::uint8_t(param), value});
+}
+
+void NetMatch::finishGame(bool won)
+{
+    victory = won;
+    phase = Revealing;
+    turn = false;
+    for (int shipId = 0; shipId < own.shipCount(); ++shipId) {
+        BoardMask cells = own.shipCells(shipId);
+        int length = cells.count();
+        int first = cells.popFirst();
+        bool horizontal = length == 1 || cells.first() == first + 1;
+        send(Reveal, first / BattleshipBoard::SIZE, first % BattleshipBoard::SIZE,
+             length | (horizontal ? 0x80 : 0), std::uint64_t(shipId));
+    }
+    send(RevealSalt, 0, 0, 0, salt[0]);
+    send(RevealDone, 0, 0, 0, salt[1]);
+}
+
+NetMatch::Event NetMatch::error()
+{
+    Event event;
+    event.kind = Event::ProtocolError;
+    return event;
+}
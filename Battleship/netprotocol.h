@@ -0,0 +1,111 @@
+#ifndef NETPROTOCOL_H
+#define NETPROTOCOL_H
+
+#include "battleshipboard.h"
+#include "standardfleet.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Сетевой протокол игры вдвоём. Каждое сообщение - ровно MESSAGE_SIZE байт:
+// u8 тип, u8 строка, u8 столбец, u8 параметр, u64 значение (little-endian).
+// Hello - версия в значении; Commit - хеш своей расстановки с солью;
+// Shot - клетка; Result - клетка, исход | корабль << 4;
+// Reveal - корабль в конце партии: клетка начала, длина | горизонтально << 7, номер в значении;
+// RevealSalt и RevealDone - первая и вторая половины соли в значении; Bye - выход из игры
+namespace NetProtocol {
+
+const std::uint8_t VERSION = 2;
+const std::uint16_t DEFAULT_PORT = 47100;
+const int MESSAGE_SIZE = 12;
+
+enum Type : std::uint8_t { Hello = 1, Commit, Shot, Result, Reveal, RevealSalt, RevealDone, Bye };
+
+// 128 случайных бит: по ним противник не может перебрать расстановки под хеш
+using Salt = std::array<std::uint64_t, 2>;
+
+struct Message {
+    std::uint8_t type;
+    std::uint8_t row, col;
+    std::uint8_t param;
+    std::uint64_t value;
+};
+
+void encode(const Message& message, std::uint8_t* out);
+// false для неизвестного типа
+bool decode(const std::uint8_t* in, Message& message);
+
+Message hello();
+Message bye();
+
+// Первые 64 бита SHA-256 от соли и масок кораблей. Хеш односторонний, поэтому под
+// отправленное значение нельзя подобрать соль для другой расстановки: флот, раскрытый
+// после партии, - тот же, что был в начале. Соль скрывает флот от противника до раскрытия
+std::uint64_t fleetCommitment(const BattleshipBoard& board, const Salt& salt);
+// Соль из системного источника случайности
+Salt randomSalt();
+
+}
+
+// Ход партии по сети без привязки к транспорту: входящие сообщения превращаются в события,
+// исходящие копятся в outbox(), пока транспорт их не заберёт.
+// Попал - стреляет снова; первым стреляет сторона с movesFirst.
+// Обе стороны играют StandardFleet: раскрытый флот с другим набором длин - обман
+class NetMatch
+{
+public:
+    enum Phase { Idle, Committed, Playing, Revealing, Finished };
+
+    struct Event {
+        enum Kind { None, OpponentReady, OpponentShot, ShotAnswered, Verified, Cheated,
+                    OpponentLeft, ProtocolError };
+
+        Kind kind = None;
+        int row = -1, col = -1;
+        ShotResult result = {ShotResult::AlreadyShot, -1};
+        BoardMask sunkCells;  // клетки потопленного корабля противника для ShotAnswered
+    };
+
+    NetMatch();
+
+    // Новая партия со своим флотом; Commit противника мог прийти и раньше
+    void start(const BattleshipBoard& fleet, bool movesFirst);
+    bool canShoot() const { return phase == Playing && turn && !shotPending; }
+    bool shoot(int row, int col);
+    Event receive(const NetProtocol::Message& message);
+
+    std::vector<NetProtocol::Message>& outbox() { return pending; }
+
+    Phase currentPhase() const { return phase; }
+    bool myTurn() const { return turn; }
+    bool won() const { return victory; }
+    const BattleshipBoard& ownBoard() const { return own; }
+    const BattleshipBoard& opponentBoard() const { return revealed; }
+    BoardMask targetShots() const { return targetHits | targetMisses; }
+
+private:
+    Phase phase;
+    BattleshipBoard own;
+    BattleshipBoard revealed;  // флот противника после Reveal
+    BoardMask targetHits;
+    BoardMask targetMisses;
+    NetProtocol::Salt salt;
+    NetProtocol::Salt opponentSalt;
+    bool opponentSaltHalf;  // первая половина соли противника уже пришла
+    std::uint64_t opponentCommitment;
+    bool opponentCommitted;
+    bool turn;
+    bool shotPending;
+    int pendingCell;
+    bool victory;
+    bool revealValid;
+    std::uint16_t revealedIds;  // номера кораблей, уже пришедших в Reveal
+    StandardFleet::LengthCounts revealedLengths;
+    std::vector<NetProtocol::Message> pending;
+
+    void send(std::uint8_t type, int row, int col, int param, std::uint64_t value);
+    void finishGame(bool won);
+    Event error();
+};
+
+#endif
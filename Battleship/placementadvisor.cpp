@@ -0,0 +1,150 @@
+#include "placementadvisor.h"
+#include "aiplayer.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+PlacementAdvisor::Job::Job(const BattleshipBoard& board, const std::vector<int>& fleet,
+                           const std::vector<int>& missing,
+                           std::shared_ptr<const PlacementWeights> weights, std::uint64_t seed)
+    : board(board), fleet(fleet), generator(missing),
+      reserved(BattleshipBoard::neighbourhood(board.occupiedCells())),
+      weights(std::move(weights)), seed(seed)
+{
+}
+
+PlacementAdvisor::PlacementAdvisor(int threads)
+    : pool(threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1)),
+      evaluations(0)
+{
+}
+
+PlacementAdvisor::~PlacementAdvisor()
+{
+    // Пул дожидается только текущих пачек: остальные задачи видят отмену и сразу выходят
+    cancel();
+}
+
+void PlacementAdvisor::evaluate(const BattleshipBoard& board, const std::vector<int>& fleet,
+                                std::shared_ptr<const PlacementWeights> weights)
+{
+    std::vector<int> missing = fleet;
+    for (int shipId = 0; shipId < board.shipCount(); ++shipId) {
+        auto it = std::find(missing.begin(), missing.end(), board.shipCells(shipId).count());
+        if (it != missing.end()) {
+            missing.erase(it);
+        }
+    }
+
+    auto next = std::make_shared<Job>(board, fleet, missing, std::move(weights),
+                                      std::random_device{}() ^ (++evaluations << 32));
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (job) {
+            job->cancelled = true;
+        }
+        job = next;
+    }
+    for (int i = 0; i < pool.threadCount(); ++i) {
+        schedule(next);
+    }
+}
+
+void PlacementAdvisor::cancel()
+{
+    std::lock_guard<std::mutex> lock(jobMutex);
+    if (job) {
+        job->cancelled = true;
+    }
+}
+
+PlacementAdvisor::Estimate PlacementAdvisor::estimate() const
+{
+    std::shared_ptr<Job> current;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        current = job;
+    }
+    Estimate result;
+    if (!current) {
+        return result;
+    }
+    Totals totals;
+    {
+        std::lock_guard<std::mutex> lock(current->totalsMutex);
+        totals = current->totals;
+    }
+    result.games = totals.games;
+    result.finished = current->failed || result.games >= TARGET_GAMES;
+    if (result.games > 0) {
+        double mean = double(totals.shots) / result.games;
+        double variance = double(totals.shotSquares) / result.games - mean * mean;
+        result.meanShots = mean;
+        result.standardError = std::sqrt(std::max(0.0, variance) / result.games);
+    }
+    return result;
+}
+
+void PlacementAdvisor::schedule(const std::shared_ptr<Job>& target)
+{
+    // Каждая задача играет одну пачку и ставит следующую, пока оценка не набрана или не отменена
+    pool.submit([this, target] {
+        int firstGame = target->claimed.fetch_add(GAMES_PER_BATCH);
+        if (target->cancelled || firstGame >= TARGET_GAMES) {
+            return;
+        }
+        runBatch(*target, firstGame);
+        if (!target->cancelled) {
+            schedule(target);
+        }
+    });
+}
+
+void PlacementAdvisor::runBatch(Job& target, int firstGame)
+{
+    std::mt19937_64 rng(target.seed + static_cast<std::uint64_t>(firstGame) * 0x9E3779B97F4A7C15ULL);
+    // Та же плотность, что у BackgroundDensity в игре, но без своего потока на каждую партию
+    AIPlayer ai(AIPlayer::Density);
+    ai.setSeed(static_cast<std::uint32_t>(rng()));
+    ai.setPlacementPrior(target.weights);
+    FleetGenerator::Layout layout;
+    const int missing = static_cast<int>(target.generator.fleet().size());
+    Totals batch;
+
+    for (int game = 0; game < GAMES_PER_BATCH && !target.cancelled; ++game) {
+        BattleshipBoard board = target.board;
+        if (missing > 0) {
+            if (!target.generator.generate(rng, layout, target.reserved)) {
+                // Остальные корабли не помещаются - оценивать нечего
+                target.failed = true;
+                target.cancelled = true;
+                break;
+            }
+            int shipId = board.shipCount();
+            for (int i = 0; i < missing; ++i) {
+                const ShipPlacement& placement = *layout[i];
+                board.placeShip(shipId++, placement.row, placement.col, placement.cells.count(),
+                                placement.horizontal);
+            }
+        }
+
+        ai.reset(target.fleet);
+        std::uint64_t shots = 0;
+        while (!board.allSunk()) {
+            auto move = ai.makeMove(board);
+            if (move.first == -1) break;
+            ShotResult result = board.attack(move.first, move.second);
+            ai.updateResult(move.first, move.second, result);
+            shots++;
+        }
+        batch.shots += shots;
+        batch.shotSquares += shots * shots;
+        batch.games++;
+    }
+
+    std::lock_guard<std::mutex> lock(target.totalsMutex);
+    target.totals.games += batch.games;
+    target.totals.shots += batch.shots;
+    target.totals.shotSquares += batch.shotSquares;
+}
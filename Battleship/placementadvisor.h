@@ -0,0 +1,82 @@
+#ifndef PLACEMENTADVISOR_H
+#define PLACEMENTADVISOR_H
+
+#include "battleshipboard.h"
+#include "fleetgenerator.h"
+#include "placementtable.h"
+#include "workstealingpool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Живучесть расстановки игрока: сколько выстрелов в среднем нужно AIPlayer, чтобы
+// потопить флот. Безголовые партии играются пачками в пуле потоков, ещё не
+// поставленные корабли в каждой партии расставляются случайно. Оценка уточняется
+// по мере прихода пачек; новый evaluate() отменяет прежнюю, ничего не дожидаясь
+class PlacementAdvisor
+{
+public:
+    static const int GAMES_PER_BATCH = 16;
+    static const int TARGET_GAMES = 4096;
+
+    struct Estimate {
+        int games = 0;
+        double meanShots = 0;
+        double standardError = 0;
+        bool finished = false;
+    };
+
+    // threads <= 0 - все ядра, кроме одного, чтобы интерфейсу осталось место
+    explicit PlacementAdvisor(int threads = 0);
+    ~PlacementAdvisor();
+
+    PlacementAdvisor(const PlacementAdvisor&) = delete;
+    PlacementAdvisor& operator=(const PlacementAdvisor&) = delete;
+
+    // board - уже поставленные корабли, fleet - весь флот, weights - как у ИИ игры
+    void evaluate(const BattleshipBoard& board, const std::vector<int>& fleet,
+                  std::shared_ptr<const PlacementWeights> weights);
+    void cancel();
+    Estimate estimate() const;
+
+private:
+    // Сумма по сыгранным партиям; пачка добавляет свою целиком, чтобы среднее
+    // и дисперсия всегда считались по одному и тому же набору партий
+    struct Totals {
+        int games = 0;
+        std::uint64_t shots = 0;
+        std::uint64_t shotSquares = 0;
+    };
+
+    // Всё, что нужно пачкам одной оценки; старые пачки держат свою копию до конца
+    struct Job {
+        BattleshipBoard board;
+        std::vector<int> fleet;
+        FleetGenerator generator;  // недостающие корабли
+        BoardMask reserved;
+        std::shared_ptr<const PlacementWeights> weights;
+        std::uint64_t seed;
+
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> failed{false};
+        std::atomic<int> claimed{0};
+        std::mutex totalsMutex;
+        Totals totals;
+
+        Job(const BattleshipBoard& board, const std::vector<int>& fleet,
+            const std::vector<int>& missing, std::shared_ptr<const PlacementWeights> weights,
+            std::uint64_t seed);
+    };
+
+    WorkStealingPool pool;
+    mutable std::mutex jobMutex;
+    std::shared_ptr<Job> job;
+    std::uint64_t evaluations;
+
+    void schedule(const std::shared_ptr<Job>& target);
+    static void runBatch(Job& target, int firstGame);
+};
+
+#endif
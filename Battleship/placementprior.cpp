@@ -0,0 +1,145 @@
+#include "placementprior.h"
+#include <algorithm>
+
+namespace {
+
+const char MAGIC[4] = {'B', 'S', 'P', 'P'};
+
+}
+
+PlacementPrior::PlacementPrior() : mapped(nullptr)
+{
+    initialize(fallback.data());
+    rebuildWeights();
+}
+
+PlacementPrior::~PlacementPrior()
+{
+    if (mapped) {
+        file.unmap(mapped);
+    }
+}
+
+bool PlacementPrior::open(const QString& path)
+{
+    if (mapped) {
+        file.unmap(mapped);
+        mapped = nullptr;
+    }
+    file.close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        rebuildWeights();
+        return false;
+    }
+
+    // Чужой, старый или обрезанный файл начинается заново
+    QByteArray header = file.read(12);
+    bool valid = file.size() == FILE_SIZE && header.size() == 12 &&
+                 std::equal(MAGIC, MAGIC + 4, header.constData());
+    if (valid) {
+        std::copy(header.constData(), header.constData() + 12, fallback.begin());
+        valid = readUint32(4) == VERSION;
+    }
+    if (!valid) {
+        initialize(fallback.data());
+        if (!file.resize(FILE_SIZE) || !file.seek(0) ||
+            file.write(reinterpret_cast<const char*>(fallback.data()), FILE_SIZE) != FILE_SIZE ||
+            !file.flush()) {
+            file.close();
+            rebuildWeights();
+            return false;
+        }
+    }
+
+    mapped = file.map(0, FILE_SIZE);
+    if (!mapped) {
+        file.close();
+        initialize(fallback.data());
+    }
+    rebuildWeights();
+    return mapped != nullptr;
+}
+
+void PlacementPrior::initialize(uchar* bytes)
+{
+    std::fill(bytes, bytes + FILE_SIZE, uchar(0));
+    std::copy(MAGIC, MAGIC + 4, bytes);
+    for (int i = 0; i < 4; ++i) {
+        bytes[4 + i] = uchar((VERSION >> (8 * i)) & 0xFF);
+    }
+}
+
+std::uint32_t PlacementPrior::readUint32(int offset) const
+{
+    const uchar* bytes = data() + offset;
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= std::uint32_t(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+void PlacementPrior::writeUint32(int offset, std::uint32_t value)
+{
+    uchar* bytes = data() + offset;
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = uchar((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void PlacementPrior::recordFleet(const BattleshipBoard& board)
+{
+    if (board.occupiedCells().none()) {
+        return;
+    }
+    if (gameCount() >= MAX_GAMES) {
+        writeUint32(8, gameCount() / 2);
+        for (int placement = 0; placement < PlacementTable::TOTAL; ++placement) {
+            writeUint32(12 + 4 * placement, count(placement) / 2);
+        }
+    }
+
+    for (int shipId = 0; shipId < board.shipCount(); ++shipId) {
+        const BoardMask& cells = board.shipCells(shipId);
+        if (cells.none()) continue;
+        int first = cells.first();
+        int length = cells.count();
+        bool horizontal = length == 1 || cells.test(first + 1);
+        int placement = PlacementTable::indexOf(first / BattleshipBoard::SIZE,
+                                                first % BattleshipBoard::SIZE, length, horizontal);
+        if (placement >= 0) {
+            writeUint32(12 + 4 * placement, count(placement) + 1);
+        }
+    }
+    writeUint32(8, gameCount() + 1);
+    rebuildWeights();
+}
+
+void PlacementPrior::rebuildWeights()
+{
+    if (gameCount() == 0) {
+        snapshot.reset();
+        return;
+    }
+
+    // Сглаженная частота положения относительно равномерной: SCALE * (c + a) * N / (n + a * N),
+    // где N - число положений этой длины, n - сколько кораблей этой длины записано
+    auto weights = std::make_shared<PlacementWeights>();
+    for (int length = 1; length <= PlacementTable::MAX_LENGTH; ++length) {
+        int first = PlacementTable::firstIndex(length);
+        int end = PlacementTable::firstIndex(length + 1);
+        std::uint64_t positions = end - first;
+        std::uint64_t observed = 0;
+        for (int placement = first; placement < end; ++placement) {
+            observed += count(placement);
+        }
+        std::uint64_t denominator = observed + PSEUDO_COUNT * positions;
+        for (int placement = first; placement < end; ++placement) {
+            std::uint64_t weight = SCALE * (count(placement) + PSEUDO_COUNT) * positions / denominator;
+            (*weights)[placement] = static_cast<std::uint32_t>(
+                std::clamp<std::uint64_t>(weight, 1, MAX_WEIGHT));
+        }
+    }
+    snapshot = std::move(weights);
+}
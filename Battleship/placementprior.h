@@ -0,0 +1,62 @@
+#ifndef PLACEMENTPRIOR_H
+#define PLACEMENTPRIOR_H
+
+#include "battleshipboard.h"
+#include "placementtable.h"
+#include <QFile>
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// Где игроки ставят свои корабли: сколько раз встречалось каждое положение из
+// PlacementTable::all(). Файл постоянного размера отображается в память один раз,
+// запись партии - несколько прибавлений к счётчикам прямо в отображении.
+// Формат: "BSPP", u32 версия, u32 число партий, u32 счётчик по каждому положению
+class PlacementPrior
+{
+public:
+    static const std::uint32_t VERSION = 1;
+    static const int FILE_SIZE = 12 + 4 * PlacementTable::TOTAL;
+    // Дальше счётчики делятся пополам, чтобы не переполнялись и следовали за новыми привычками
+    static const std::uint32_t MAX_GAMES = 4096;
+    // Вес положения при равномерной расстановке; больше - игроки ставят сюда чаще
+    static const std::uint32_t SCALE = 16;
+    static const std::uint32_t MAX_WEIGHT = 64 * SCALE;
+    // Сглаживание: столько воображаемых кораблей в каждом положении
+    static const std::uint32_t PSEUDO_COUNT = 4;
+
+    PlacementPrior();
+    ~PlacementPrior();
+
+    PlacementPrior(const PlacementPrior&) = delete;
+    PlacementPrior& operator=(const PlacementPrior&) = delete;
+
+    // Открывает (или создаёт) файл и отображает его; при ошибке счётчики живут только в памяти
+    bool open(const QString& path);
+    bool isMapped() const { return mapped != nullptr; }
+
+    // Расстановка игрока после партии
+    void recordFleet(const BattleshipBoard& board);
+
+    std::uint32_t gameCount() const { return readUint32(8); }
+    std::uint32_t count(int placement) const { return readUint32(12 + 4 * placement); }
+    // Веса для DensityModel и IncrementalDensity; nullptr, пока партий не было.
+    // Неизменяемый снимок, его можно отдать другому потоку
+    std::shared_ptr<const PlacementWeights> weights() const { return snapshot; }
+
+private:
+    QFile file;
+    uchar* mapped;
+    std::array<uchar, FILE_SIZE> fallback;
+    std::shared_ptr<const PlacementWeights> snapshot;
+
+    uchar* data() { return mapped ? mapped : fallback.data(); }
+    const uchar* data() const { return mapped ? mapped : fallback.data(); }
+    std::uint32_t readUint32(int offset) const;
+    void writeUint32(int offset, std::uint32_t value);
+    void initialize(uchar* bytes);
+    void rebuildWeights();
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef PLACEMENTTABLE_H
+#define PLACEMENTTABLE_H
+
+#include "battleshipboard.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct ShipPlacement {
+    BoardMask cells;
+    BoardMask halo;  // клетки корабля вместе с соседними
+    int row, col;
+    bool horizontal;
+};
+
+// Непрерывный участок таблицы положений
+class PlacementRange
+{
+public:
+    constexpr PlacementRange(const ShipPlacement* first, const ShipPlacement* last)
+        : first(first), last(last) {}
+
+    constexpr const ShipPlacement* begin() const { return first; }
+    constexpr const ShipPlacement* end() const { return last; }
+    constexpr std::size_t size() const { return static_cast<std::size_t>(last - first); }
+    constexpr bool empty() const { return first == last; }
+    constexpr const ShipPlacement& operator[](std::size_t index) const { return first[index]; }
+
+private:
+    const ShipPlacement* first;
+    const ShipPlacement* last;
+};
+
+// Все положения кораблей длины 1..MAX_LENGTH на пустом поле подряд: по длине,
+// сначала горизонтальные, затем вертикальные, по строкам и столбцам.
+// Таблица строится при компиляции и лежит в памяти только для чтения
+namespace PlacementGeometry {
+
+constexpr int SIZE = BoardGeometry::SIZE;
+constexpr int MAX_LENGTH = SIZE;
+
+// Однопалубный корабль в обоих направлениях одинаков и учитывается один раз
+constexpr int count(int length)
+{
+    return length < 1 || length > MAX_LENGTH ? 0
+           : length == 1                     ? SIZE * SIZE
+                                             : 2 * SIZE * (SIZE - length + 1);
+}
+
+constexpr int offset(int length)
+{
+    int result = 0;
+    for (int shorter = 1; shorter < length && shorter <= MAX_LENGTH; ++shorter) {
+        result += count(shorter);
+    }
+    return result;
+}
+
+constexpr int TOTAL = offset(MAX_LENGTH + 1);
+
+constexpr std::array<ShipPlacement, TOTAL> build()
+{
+    std::array<ShipPlacement, TOTAL> table{};
+    int index = 0;
+    for (int length = 1; length <= MAX_LENGTH; ++length) {
+        for (int orientation = 0; orientation < 2; ++orientation) {
+            bool horizontal = orientation == 0;
+            if (length == 1 && !horizontal) {
+                continue;
+            }
+            for (int row = 0; row < SIZE; ++row) {
+                for (int col = 0; col < SIZE; ++col) {
+                    BoardMask cells = BattleshipBoard::shipMask(row, col, length, horizontal);
+                    if (cells.none()) {
+                        continue;
+                    }
+                    table[index++] = {cells, BattleshipBoard::neighbourhood(cells),
+                                      row, col, horizontal};
+                }
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<ShipPlacement, TOTAL> PLACEMENTS = build();
+
+}
+
+class PlacementTable
+{
+public:
+    static constexpr int MAX_LENGTH = PlacementGeometry::MAX_LENGTH;
+    static constexpr int TOTAL = PlacementGeometry::TOTAL;
+
+    // Положения корабля длины length; для недопустимой длины - пустой участок
+    static constexpr PlacementRange placements(int length)
+    {
+        const ShipPlacement* table = PlacementGeometry::PLACEMENTS.data();
+        return length >= 1 && length <= MAX_LENGTH
+                   ? PlacementRange(table + PlacementGeometry::offset(length),
+                                    table + PlacementGeometry::offset(length + 1))
+                   : PlacementRange(table, table);
+    }
+
+    // Положения всех длин; индекс в этом участке общий для всех длин
+    static constexpr PlacementRange all()
+    {
+        return PlacementRange(PlacementGeometry::PLACEMENTS.data(),
+                              PlacementGeometry::PLACEMENTS.data() + TOTAL);
+    }
+
+    static constexpr int firstIndex(int length) { return PlacementGeometry::offset(length); }
+
+    // Индекс положения в all() или -1, если корабль не помещается на поле
+    static constexpr int indexOf(int row, int col, int length, bool horizontal)
+    {
+        const int SIZE = PlacementGeometry::SIZE;
+        const int span = SIZE - length + 1;
+        if (BattleshipBoard::shipMask(row, col, length, horizontal).none()) {
+            return -1;
+        }
+        if (length == 1) {
+            return firstIndex(1) + row * SIZE + col;
+        }
+        return firstIndex(length) + (horizontal ? row * span + col : SIZE * span + row * SIZE + col);
+    }
+};
+
+// Множитель веса для каждого положения из PlacementTable::all()
+using PlacementWeights = std::array<std::uint32_t, PlacementTable::TOTAL>;
+
+static_assert(PlacementTable::placements(5)[0].cells == BattleshipBoard::shipMask(0, 0, 5, true),
+              "порядок положений в таблице");
+static_assert(PlacementTable::all()[PlacementTable::indexOf(6, 9, 4, false)].cells ==
+              BattleshipBoard::shipMask(6, 9, 4, false), "индекс положения");
+static_assert(PlacementTable::all()[PlacementTable::indexOf(9, 7, 3, true)].cells ==
+              BattleshipBoard::shipMask(9, 7, 3, true), "индекс положения");
+
+#endif
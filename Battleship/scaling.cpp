@@ -0,0 +1,110 @@
+// Масштабирование больших полей: расстановка и партия SparseHunter против
+// SparseBoard для полей от 10x10 до 1000x1000 с флотом scaledFleet(size)
+// battleship_scaling [--sizes 10,100,1000] [--games N] [--seed S]
+
+#include "sparseboard.h"
+#include "sparsehunter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedNs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> sizes = {10, 32, 100, 316, 1000};
+    int maxGames = 200;
+    std::uint64_t seed = std::random_device{}();
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--sizes") && hasValue) {
+            sizes.clear();
+            std::stringstream list(argv[++i]);
+            std::string size;
+            while (std::getline(list, size, ',')) {
+                sizes.push_back(std::max(1, std::min(SparseBoard::MAX_SIZE, std::atoi(size.c_str()))));
+            }
+        } else if (!std::strcmp(argv[i], "--games") && hasValue) {
+            maxGames = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--sizes 10,100,1000] [--games N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("%6s %6s %6s %12s %12s %10s %10s %10s %10s %12s\n", "size", "ships", "games",
+                "place us", "shots/game", "shot %", "ns/move", "p99 ns", "max ns", "index cells");
+
+    std::mt19937_64 rng(seed);
+    for (int size : sizes) {
+        std::vector<int> fleet = scaledFleet(size);
+        // На больших полях партия длинная - меньше партий, примерно одинаковое время на размер
+        int games = std::max(1, std::min(maxGames, 2000000 / (size * size)));
+
+        double placeNs = 0, moveNs = 0;
+        // Время каждого хода: среднее скрывает редкие ходы, которые просматривают много клеток
+        std::vector<float> moveTimes;
+        std::uint64_t moves = 0, shots = 0;
+        std::size_t indexCells = 0;
+        int played = 0;
+        SparseBoard board(size, size);
+        SparseHunter hunter;
+
+        for (int game = 0; game < games; ++game) {
+            // Освобождение выстрелов прошлой партии не входит во время расстановки
+            board.clear(size, size);
+            auto start = Clock::now();
+            if (!board.placeFleet(fleet, rng)) {
+                std::fprintf(stderr, "fleet does not fit on %dx%d\n", size, size);
+                break;
+            }
+            placeNs += elapsedNs(start);
+            hunter.reset(size, size, fleet, rng());
+
+            start = Clock::now();
+            while (!board.allSunk()) {
+                auto move = hunter.makeMove();
+                if (move.first < 0) break;
+                hunter.updateResult(move.first, move.second, board.attack(move.first, move.second));
+                moves++;
+                auto now = Clock::now();
+                double ns = std::chrono::duration<double, std::nano>(now - start).count();
+                start = now;
+                moveNs += ns;
+                moveTimes.push_back(static_cast<float>(ns));
+            }
+            shots += board.shotCount();
+            indexCells = board.occupiedCount();
+            played++;
+        }
+        if (played == 0 || moveTimes.empty()) continue;
+
+        auto p99 = moveTimes.begin() + moveTimes.size() * 99 / 100;
+        std::nth_element(moveTimes.begin(), p99, moveTimes.end());
+        float worst = *std::max_element(moveTimes.begin(), moveTimes.end());
+        std::printf("%6d %6zu %6d %12.1f %12.1f %10.2f %10.1f %10.0f %10.0f %12zu\n", size, fleet.size(), played,
+                    placeNs / played / 1000.0, double(shots) / played,
+                    100.0 * shots / played / (double(size) * size), moveNs / moves, *p99, worst,
+                    indexCells);
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "shotheatmap.h"
+#include <QFile>
+#include <QByteArray>
+#include <algorithm>
+
+namespace {
+
+const char MAGIC[4] = {'B', 'S', 'H', 'M'};
+
+void appendUint32(QByteArray& data, std::uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        data.append(char((value >> shift) & 0xFF));
+    }
+}
+
+std::uint32_t readUint32(const QByteArray& data, int offset)
+{
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= std::uint32_t(std::uint8_t(data[offset + i])) << (8 * i);
+    }
+    return value;
+}
+
+}
+
+ShotHeatmap::ShotHeatmap() : games(0)
+{
+    rankSums.fill(0);
+    rebuildPlanes();
+}
+
+bool ShotHeatmap::load(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data = file.readAll();
+    if (data.size() != FILE_SIZE || !std::equal(MAGIC, MAGIC + 4, data.constData()) ||
+        readUint32(data, 4) != VERSION) {
+        return false;
+    }
+    games = readUint32(data, 8);
+    for (int cell = 0; cell < BattleshipBoard::CELL_COUNT; ++cell) {
+        rankSums[cell] = readUint32(data, 12 + 4 * cell);
+    }
+    rebuildPlanes();
+    return true;
+}
+
+bool ShotHeatmap::save(const QString& path) const
+{
+    QByteArray data(MAGIC, 4);
+    appendUint32(data, VERSION);
+    appendUint32(data, games);
+    for (std::uint32_t sum : rankSums) {
+        appendUint32(data, sum);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
+void ShotHeatmap::recordGame(const std::vector<int>& shotOrder)
+{
+    if (shotOrder.empty()) {
+        return;
+    }
+    if (games >= MAX_GAMES) {
+        games /= 2;
+        for (auto& sum : rankSums) sum /= 2;
+    }
+
+    std::array<int, BattleshipBoard::CELL_COUNT> rank;
+    rank.fill(BattleshipBoard::CELL_COUNT);
+    for (int i = static_cast<int>(shotOrder.size()) - 1; i >= 0; --i) {
+        rank[shotOrder[i]] = i;
+    }
+    for (int cell = 0; cell < BattleshipBoard::CELL_COUNT; ++cell) {
+        rankSums[cell] += rank[cell];
+    }
+    games++;
+    rebuildPlanes();
+}
+
+double ShotHeatmap::lateness(int cell) const
+{
+    return games ? double(rankSums[cell]) / games : 0.0;
+}
+
+void ShotHeatmap::rebuildPlanes()
+{
+    planes.fill(BoardMask());
+    for (int cell = 0; cell < BattleshipBoard::CELL_COUNT; ++cell) {
+        int level = std::min(255, int(lateness(cell) * 255 / BattleshipBoard::CELL_COUNT));
+        for (int bit = 0; bit < SCORE_BITS; ++bit) {
+            if (level & (1 << bit)) planes[bit].set(cell);
+        }
+    }
+}
+
+int ShotHeatmap::score(const BoardMask& cells) const
+{
+    int total = 0;
+    for (int bit = 0; bit < SCORE_BITS; ++bit) {
+        total += (cells & planes[bit]).count() << bit;
+    }
+    return total;
+}
+
+bool ShotHeatmap::chooseLayout(const FleetGenerator& generator, std::mt19937_64& rng,
+                               FleetGenerator::Layout& layout) const
+{
+    const int shipCount = static_cast<int>(generator.fleet().size());
+    int bestScore = -1;
+    FleetGenerator::Layout candidate;
+    for (int i = 0; i < CANDIDATE_LAYOUTS; ++i) {
+        if (!generator.generate(rng, candidate)) {
+            return false;
+        }
+        BoardMask cells;
+        for (int ship = 0; ship < shipCount; ++ship) {
+            cells |= candidate[ship]->cells;
+        }
+        int candidateScore = score(cells);
+        if (candidateScore > bestScore) {
+            bestScore = candidateScore;
+            layout = candidate;
+        }
+    }
+    return true;
+}
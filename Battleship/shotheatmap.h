@@ -0,0 +1,51 @@
+#ifndef SHOTHEATMAP_H
+#define SHOTHEATMAP_H
+
+#include "battleshipboard.h"
+#include "fleetgenerator.h"
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Как поздно игроки стреляют по каждой клетке. Хранится в файле постоянного размера:
+// "BSHM", u32 версия, u32 число партий, u32 сумма номеров выстрела по каждой клетке
+// (не обстрелянная за партию клетка получает номер CELL_COUNT)
+class ShotHeatmap
+{
+public:
+    static const std::uint32_t VERSION = 1;
+    static const int FILE_SIZE = 12 + 4 * BattleshipBoard::CELL_COUNT;
+    // Дальше суммы делятся пополам, чтобы карта следовала за новыми привычками игроков
+    static const std::uint32_t MAX_GAMES = 1024;
+    static const int CANDIDATE_LAYOUTS = 64;
+    static const int SCORE_BITS = 8;
+
+    ShotHeatmap();
+
+    bool load(const QString& path);
+    bool save(const QString& path) const;
+
+    // Клетки, по которым стрелял игрок, в порядке выстрелов
+    void recordGame(const std::vector<int>& shotOrder);
+
+    std::uint32_t gameCount() const { return games; }
+    // Средний номер выстрела по клетке, 0..CELL_COUNT
+    double lateness(int cell) const;
+    // Сумма поздности клеток маски, посчитанная по битовым плоскостям
+    int score(const BoardMask& cells) const;
+
+    // Лучшая по поздности из CANDIDATE_LAYOUTS равномерно случайных расстановок
+    bool chooseLayout(const FleetGenerator& generator, std::mt19937_64& rng,
+                      FleetGenerator::Layout& layout) const;
+
+private:
+    std::uint32_t games;
+    std::array<std::uint32_t, BattleshipBoard::CELL_COUNT> rankSums;
+    std::array<BoardMask, SCORE_BITS> planes;  // бит k поздности клетки, 0..255
+
+    void rebuildPlanes();
+};
+
+#endif
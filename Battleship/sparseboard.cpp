@@ -0,0 +1,129 @@
+#include "sparseboard.h"
+#include "standardfleet.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+const int FLEET_ATTEMPTS = 64;
+const int SHIP_ATTEMPTS = 1000;
+
+}
+
+SparseBoard::SparseBoard(int rows, int cols)
+{
+    clear(rows, cols);
+}
+
+void SparseBoard::clear(int newRows, int newCols)
+{
+    rows = std::max(1, std::min(newRows, MAX_SIZE));
+    cols = std::max(1, std::min(newCols, MAX_SIZE));
+    ships.clear();
+    cellShip.clear();
+    shots.assign((std::size_t(rows) * cols + 63) / 64, 0);
+    shotTotal = 0;
+    afloat = 0;
+}
+
+bool SparseBoard::canPlaceShip(int row, int col, int length, bool horizontal) const
+{
+    int lastRow = horizontal ? row : row + length - 1;
+    int lastCol = horizontal ? col + length - 1 : col;
+    if (length <= 0 || !inBounds(row, col) || !inBounds(lastRow, lastCol)) {
+        return false;
+    }
+    for (int r = std::max(0, row - 1); r <= std::min(rows - 1, lastRow + 1); ++r) {
+        for (int c = std::max(0, col - 1); c <= std::min(cols - 1, lastCol + 1); ++c) {
+            if (cellShip.count(cellIndex(r, c))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int SparseBoard::placeShip(int row, int col, int length, bool horizontal)
+{
+    if (!canPlaceShip(row, col, length, horizontal)) {
+        return -1;
+    }
+    int shipId = shipCount();
+    ships.push_back({row, col, length, horizontal, length});
+    for (int i = 0; i < length; ++i) {
+        cellShip[horizontal ? cellIndex(row, col + i) : cellIndex(row + i, col)] = shipId;
+    }
+    afloat++;
+    return shipId;
+}
+
+bool SparseBoard::placeFleet(const std::vector<int>& fleet, std::mt19937_64& rng)
+{
+    std::vector<int> lengths = fleet;
+    std::sort(lengths.begin(), lengths.end(), std::greater<int>());
+
+    clear(rows, cols);
+    for (int attempt = 0; attempt < FLEET_ATTEMPTS; ++attempt) {
+        ships.clear();
+        cellShip.clear();
+        afloat = 0;
+        bool placed = true;
+        for (int length : lengths) {
+            int tries = 0;
+            for (; tries < SHIP_ATTEMPTS; ++tries) {
+                bool horizontal = rng() & 1;
+                int rowLimit = horizontal ? rows : rows - length + 1;
+                int colLimit = horizontal ? cols - length + 1 : cols;
+                if (rowLimit <= 0 || colLimit <= 0) continue;
+                int row = static_cast<int>(rng() % rowLimit);
+                int col = static_cast<int>(rng() % colLimit);
+                if (placeShip(row, col, length, horizontal) >= 0) break;
+            }
+            if (tries == SHIP_ATTEMPTS) {
+                placed = false;
+                break;
+            }
+        }
+        if (placed) {
+            return true;
+        }
+    }
+    clear(rows, cols);
+    return false;
+}
+
+ShotResult SparseBoard::attack(int row, int col)
+{
+    if (!inBounds(row, col)) {
+        return {ShotResult::AlreadyShot, -1};
+    }
+    if (isShot(row, col)) {
+        return {ShotResult::AlreadyShot, shipAt(row, col)};
+    }
+    int cell = cellIndex(row, col);
+    shots[cell >> 6] |= std::uint64_t(1) << (cell & 63);
+    shotTotal++;
+    int shipId = shipAt(row, col);
+    if (shipId < 0) {
+        return {ShotResult::Miss, -1};
+    }
+    if (--ships[shipId].remaining > 0) {
+        return {ShotResult::Hit, shipId};
+    }
+    return {--afloat == 0 ? ShotResult::FleetDestroyed : ShotResult::Sunk, shipId};
+}
+
+int SparseBoard::shipAt(int row, int col) const
+{
+    auto it = cellShip.find(cellIndex(row, col));
+    return it == cellShip.end() ? -1 : it->second;
+}
+
+std::vector<int> scaledFleet(int size)
+{
+    std::vector<int> fleet;
+    for (int copy = 0; copy < std::max(1, size / BattleshipBoard::SIZE); ++copy) {
+        fleet.insert(fleet.end(), StandardFleet::LENGTHS.begin(), StandardFleet::LENGTHS.end());
+    }
+    return fleet;
+}
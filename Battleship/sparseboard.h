@@ -0,0 +1,70 @@
+#ifndef SPARSEBOARD_H
+#define SPARSEBOARD_H
+
+#include "battleshipboard.h"
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Поле произвольного размера до MAX_SIZE x MAX_SIZE для больших партий.
+// Корабли хранятся разреженно - индекс клетка -> корабль только для клеток кораблей;
+// выстрелы - по биту на клетку (125 КБ для 1000x1000), без узлов хеш-таблицы на каждый ход
+class SparseBoard
+{
+public:
+    static constexpr int MAX_SIZE = 1000;
+
+    struct Ship {
+        int row, col, length;
+        bool horizontal;
+        int remaining;  // непоражённые клетки
+    };
+
+    SparseBoard(int rows = BattleshipBoard::SIZE, int cols = BattleshipBoard::SIZE);
+
+    void clear(int rows, int cols);
+
+    int rowCount() const { return rows; }
+    int columnCount() const { return cols; }
+    int cellIndex(int row, int col) const { return row * cols + col; }
+    bool inBounds(int row, int col) const
+    {
+        return row >= 0 && row < rows && col >= 0 && col < cols;
+    }
+
+    // Корабль в пределах поля и не касается других, в том числе углами
+    bool canPlaceShip(int row, int col, int length, bool horizontal) const;
+    // Номер нового корабля или -1
+    int placeShip(int row, int col, int length, bool horizontal);
+    // Случайная расстановка на очищенном поле; false, если флот не удалось разместить
+    bool placeFleet(const std::vector<int>& fleet, std::mt19937_64& rng);
+
+    ShotResult attack(int row, int col);
+
+    int shipAt(int row, int col) const;
+    bool isShot(int row, int col) const
+    {
+        int cell = cellIndex(row, col);
+        return (shots[cell >> 6] >> (cell & 63)) & 1;
+    }
+    bool allSunk() const { return afloat == 0; }
+    int shipsAfloat() const { return afloat; }
+    int shipCount() const { return static_cast<int>(ships.size()); }
+    const Ship& ship(int shipId) const { return ships[shipId]; }
+    std::size_t shotCount() const { return shotTotal; }
+    std::size_t occupiedCount() const { return cellShip.size(); }
+
+private:
+    int rows, cols;
+    std::vector<Ship> ships;
+    std::unordered_map<int, int> cellShip;
+    std::vector<std::uint64_t> shots;
+    std::size_t shotTotal;
+    int afloat;
+};
+
+// Флот для поля size x size: стандартный флот, повторённый size / 10 раз
+std::vector<int> scaledFleet(int size);
+
+#endif
@@ -0,0 +1,160 @@
+#include "sparsehunter.h"
+#include <algorithm>
+#include <numeric>
+
+SparseHunter::SparseHunter()
+    : rows(0), cols(0), cellCount(0), multiplier(1), offset(0), huntIndex(0), huntEnd(0), stride(1), phase(0)
+{
+}
+
+void SparseHunter::reset(int newRows, int newCols, const std::vector<int>& fleet, std::uint64_t seed)
+{
+    rows = newRows;
+    cols = newCols;
+    rng.seed(seed);
+    lengthCount.clear();
+    for (int length : fleet) {
+        lengthCount[length]++;
+    }
+    closed.assign((std::size_t(rows) * cols + 63) / 64, 0);
+    openHits.clear();
+    targets.clear();
+
+    cellCount = std::uint64_t(rows) * cols;
+    multiplier = cellCount > 1 ? 1 + rng() % (cellCount - 1) : 1;
+    while (std::gcd(multiplier, cellCount) != 1) {
+        multiplier++;
+    }
+    offset = cellCount > 0 ? rng() % cellCount : 0;
+    huntIndex = 0;
+    restartHunt();
+}
+
+void SparseHunter::restartHunt()
+{
+    stride = lengthCount.empty() ? 1 : lengthCount.begin()->first;
+    stride = std::max(1, stride);
+    phase = static_cast<int>(rng() % stride);
+    // Пройденные клетки новой решётки могли быть пропущены старой, поэтому нужен
+    // полный круг, но от текущего места: начало обхода уже почти всё закрыто
+    huntEnd = huntIndex + cellCount;
+}
+
+int SparseHunter::nextHuntCell()
+{
+    for (;;) {
+        while (huntIndex < huntEnd) {
+            int cell = static_cast<int>((multiplier * (huntIndex++ % cellCount) + offset) % cellCount);
+            if ((cell / cols + cell % cols) % stride == phase && available(cell)) {
+                return cell;
+            }
+        }
+        if (stride == 1) {
+            return -1;
+        }
+        // Решётка пройдена, а корабли остались (например, флот не такой, как заявлен)
+        stride = 1;
+        phase = 0;
+        huntEnd = huntIndex + cellCount;
+    }
+}
+
+std::pair<int, int> SparseHunter::makeMove()
+{
+    while (!targets.empty()) {
+        int cell = targets.back();
+        targets.pop_back();
+        if (available(cell)) {
+            return {cell / cols, cell % cols};
+        }
+    }
+    int cell = nextHuntCell();
+    if (cell < 0) {
+        return {-1, -1};
+    }
+    return {cell / cols, cell % cols};
+}
+
+void SparseHunter::exclude(int row, int col)
+{
+    if (row >= 0 && row < rows && col >= 0 && col < cols) {
+        close(row * cols + col);
+    }
+}
+
+void SparseHunter::pushTarget(int row, int col)
+{
+    if (row >= 0 && row < rows && col >= 0 && col < cols && available(row * cols + col)) {
+        targets.push_back(row * cols + col);
+    }
+}
+
+void SparseHunter::updateResult(int row, int col, const ShotResult& result)
+{
+    int cell = row * cols + col;
+    close(cell);
+    if (!result.hit()) {
+        return;
+    }
+
+    // Корабли не касаются, поэтому по диагонали от попадания кораблей нет
+    openHits.insert(cell);
+    for (int dr = -1; dr <= 1; dr += 2) {
+        for (int dc = -1; dc <= 1; dc += 2) {
+            exclude(row + dr, col + dc);
+        }
+    }
+
+    auto isOpenHit = [this](int r, int c) {
+        return r >= 0 && r < rows && c >= 0 && c < cols && openHits.count(r * cols + c);
+    };
+    bool horizontal = isOpenHit(row, col - 1) || isOpenHit(row, col + 1);
+    bool vertical = isOpenHit(row - 1, col) || isOpenHit(row + 1, col);
+
+    // Отрезок открытых попаданий через клетку выстрела
+    int dr = vertical ? 1 : 0;
+    int dc = vertical ? 0 : 1;
+    int first = 0, last = 0;
+    while (isOpenHit(row - dr * (first + 1), col - dc * (first + 1))) first++;
+    while (isOpenHit(row + dr * (last + 1), col + dc * (last + 1))) last++;
+
+    if (!result.sunk()) {
+        if (!horizontal && !vertical) {
+            pushTarget(row, col - 1);
+            pushTarget(row, col + 1);
+            pushTarget(row - 1, col);
+            pushTarget(row + 1, col);
+            return;
+        }
+        // Направление известно: по бокам отрезка кораблей нет, продолжаем с обоих концов
+        for (int i = -first; i <= last; ++i) {
+            exclude(row + dr * i + dc, col + dc * i + dr);
+            exclude(row + dr * i - dc, col + dc * i - dr);
+        }
+        pushTarget(row + dr * (last + 1), col + dc * (last + 1));
+        pushTarget(row - dr * (first + 1), col - dc * (first + 1));
+        return;
+    }
+
+    for (int i = -first; i <= last; ++i) {
+        int r = row + dr * i;
+        int c = col + dc * i;
+        openHits.erase(r * cols + c);
+        for (int nr = r - 1; nr <= r + 1; ++nr) {
+            for (int nc = c - 1; nc <= c + 1; ++nc) {
+                exclude(nr, nc);
+            }
+        }
+    }
+
+    auto it = lengthCount.find(first + last + 1);
+    if (it != lengthCount.end()) {
+        int shortest = lengthCount.begin()->first;
+        if (--it->second == 0) {
+            lengthCount.erase(it);
+        }
+        if (!lengthCount.empty() && lengthCount.begin()->first != shortest) {
+            restartHunt();
+        }
+    }
+}
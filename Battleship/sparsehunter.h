@@ -0,0 +1,56 @@
+#ifndef SPARSEHUNTER_H
+#define SPARSEHUNTER_H
+
+#include "battleshipboard.h"
+#include <cstdint>
+#include <map>
+#include <random>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// ИИ для SparseBoard. Полного просмотра поля нет: в поиске клетки решётки
+// (row + col) % шаг == фаза, где шаг - длина самого короткого оставшегося корабля,
+// перебираются в псевдослучайном порядке без хранения; после попадания
+// ход берётся из небольшого набора кандидатов вокруг открытых попаданий.
+// Смена решётки не начинает обход заново: он продолжается с того же места
+// на один круг, так что за партию обход проходит поле лишь несколько раз
+class SparseHunter
+{
+public:
+    SparseHunter();
+
+    void reset(int rows, int cols, const std::vector<int>& fleet, std::uint64_t seed);
+    // {-1, -1}, если стрелять больше некуда
+    std::pair<int, int> makeMove();
+    void updateResult(int row, int col, const ShotResult& result);
+
+    std::size_t candidateCount() const { return targets.size(); }
+
+private:
+    int rows, cols;
+    std::mt19937_64 rng;
+    std::map<int, int> lengthCount;            // длина -> сколько таких кораблей осталось
+    std::vector<std::uint64_t> closed;         // обстреляна или кораблей там быть не может
+    std::unordered_set<int> openHits;          // попадания в ещё не потопленные корабли
+    std::vector<int> targets;                  // кандидаты добивания, последний - первый
+
+    // Обход клеток в порядке (multiplier * i + offset) mod cellCount; i растёт
+    // непрерывно, решётка пройдена целиком, когда i дошёл до huntEnd
+    std::uint64_t cellCount;
+    std::uint64_t multiplier;
+    std::uint64_t offset;
+    std::uint64_t huntIndex;
+    std::uint64_t huntEnd;
+    int stride;
+    int phase;
+
+    bool available(int cell) const { return !((closed[cell >> 6] >> (cell & 63)) & 1); }
+    void close(int cell) { closed[cell >> 6] |= std::uint64_t(1) << (cell & 63); }
+    void restartHunt();
+    int nextHuntCell();
+    void exclude(int row, int col);
+    void pushTarget(int row, int col);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef STANDARDFLEET_H
+#define STANDARDFLEET_H
+
+#include "densitymodel.h"
+#include "placementtable.h"
+#include <array>
+#include <vector>
+
+// Флот, который расставляет BattleshipGame::createShips. Для него карта плотности
+// до первого выстрела известна заранее и вычисляется при компиляции
+namespace StandardFleet {
+
+constexpr std::array<int, 5> LENGTHS = {5, 4, 3, 3, 2};
+
+using LengthCounts = std::array<int, PlacementTable::MAX_LENGTH + 1>;
+
+constexpr LengthCounts lengthCounts()
+{
+    LengthCounts counts{};
+    for (int length : LENGTHS) {
+        counts[length]++;
+    }
+    return counts;
+}
+
+constexpr LengthCounts LENGTH_COUNTS = lengthCounts();
+
+// То же, что DensityModel::compute на пустом поле: каждое положение даёт
+// своим клеткам число ещё не найденных кораблей этой длины
+constexpr DensityModel::Grid openingDensity()
+{
+    DensityModel::Grid density{};
+    for (int length = 1; length <= PlacementTable::MAX_LENGTH; ++length) {
+        if (LENGTH_COUNTS[length] == 0) continue;
+        for (const ShipPlacement& placement : PlacementTable::placements(length)) {
+            for (BoardMask cells = placement.cells; cells.any();) {
+                density[cells.popFirst()] += LENGTH_COUNTS[length];
+            }
+        }
+    }
+    return density;
+}
+
+constexpr DensityModel::Grid OPENING_DENSITY = openingDensity();
+
+inline bool matches(const LengthCounts& counts)
+{
+    return counts == LENGTH_COUNTS;
+}
+
+inline std::vector<int> fleet()
+{
+    return std::vector<int>(LENGTHS.begin(), LENGTHS.end());
+}
+
+}
+
+// Угол накрывают по одному горизонтальному и вертикальному положению каждого корабля
+static_assert(StandardFleet::OPENING_DENSITY[0] == 2 * 5, "плотность в углу");
+
+#endif
@@ -0,0 +1,284 @@
+// Безголовый прогон стратегий AIPlayer против случайных флотов:
+// battleship_tournament [--games N] [--threads T] [--strategy density|hunt|montecarlo|background]
+//                       [--budget-us U] [--sampler-threads K] [--salvo K] [--seed S] [--log FILE]
+// С --salvo ИИ стреляет залпами по K клеток, и статистика считается в залпах
+// battleship_tournament --scan FILE - сводка по журналу партий
+
+#include "aiplayer.h"
+#include "battleshipboard.h"
+#include "fleetgenerator.h"
+#include "gamelog.h"
+#include "standardfleet.h"
+#include "workstealingpool.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<int> STANDARD_FLEET = StandardFleet::fleet();
+const int GAMES_PER_TASK = 4096;
+const int LATENCY_BUCKETS = 24;  // степени двойки в наносекундах
+
+struct alignas(64) WorkerStats {
+    std::array<std::uint64_t, BattleshipBoard::CELL_COUNT + 1> shots{};
+    std::array<std::uint64_t, LATENCY_BUCKETS> latency{};
+    std::uint64_t games = 0;
+    std::uint64_t moves = 0;
+    double latencyNs = 0;
+};
+
+int latencyBucket(std::int64_t ns)
+{
+    int bucket = 0;
+    while (ns > 1 && bucket < LATENCY_BUCKETS - 1) {
+        ns >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+struct Settings {
+    AIPlayer::Strategy strategy = AIPlayer::Density;
+    std::chrono::microseconds budget{5000};
+    int samplerThreads = 1;
+    int salvo = 0;
+    GameLogWriter* log = nullptr;
+};
+
+void playGames(int count, std::uint64_t seed, const Settings& settings, WorkerStats& stats)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::mt19937_64 rng(seed);
+    AIPlayer ai(settings.strategy);
+    ai.setSeed(static_cast<std::uint32_t>(seed));
+    ai.setTimeBudget(settings.budget);
+    ai.setSamplerThreads(settings.samplerThreads);
+    BattleshipBoard board;
+    const BattleshipBoard noFleet;
+    FleetGenerator generator(STANDARD_FLEET);
+    GameRecorder recorder;
+    QByteArray records;
+
+    for (int game = 0; game < count; ++game) {
+        generator.generate(rng, board);
+        ai.reset(STANDARD_FLEET);
+        if (settings.log) {
+            recorder.beginGame(board, noFleet);
+        }
+
+        int shots = 0;
+        int volleys = 0;
+        while (settings.salvo > 0 && !board.allSunk()) {
+            auto start = Clock::now();
+            BoardMask targets = ai.makeSalvo(board, settings.salvo);
+            SalvoResult salvo = board.attack(targets);
+            ai.updateSalvo(salvo);
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            stats.latency[latencyBucket(elapsed)]++;
+            stats.latencyNs += elapsed;
+            stats.moves++;
+
+            if (salvo.count == 0) {
+                break;
+            }
+            for (int shot = 0; shot < salvo.count && settings.log; ++shot) {
+                int cell = salvo.cells[shot];
+                recorder.recordShot(1, cell / BattleshipBoard::SIZE, cell % BattleshipBoard::SIZE,
+                                    salvo.results[shot]);
+            }
+            shots = ++volleys;
+        }
+        while (settings.salvo == 0 && !board.allSunk() && shots < BattleshipBoard::CELL_COUNT) {
+            auto start = Clock::now();
+            auto move = ai.makeMove(board);
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            stats.latency[latencyBucket(elapsed)]++;
+            stats.latencyNs += elapsed;
+            stats.moves++;
+
+            if (move.first < 0 || board.isShot(move.first, move.second)) {
+                break;
+            }
+            ShotResult result = board.attack(move.first, move.second);
+            ai.updateResult(move.first, move.second, result);
+            if (settings.log) {
+                recorder.recordShot(1, move.first, move.second, result);
+            }
+            shots++;
+        }
+        stats.shots[shots]++;
+        stats.games++;
+        if (settings.log) {
+            records.append(recorder.finishGame());
+        }
+    }
+    if (settings.log) {
+        settings.log->append(records);
+    }
+}
+
+int scanLog(const char* path)
+{
+    GameLogReader reader;
+    if (!reader.open(QString::fromLocal8Bit(path))) {
+        std::fprintf(stderr, "cannot read game log: %s\n", path);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t games = 0;
+    std::array<std::uint64_t, 2> shots{};
+    std::array<std::uint64_t, 2> hits{};
+    std::size_t offset = 0;
+    GameLog::GameView game;
+    while (reader.next(offset, game)) {
+        for (int i = 0, count = game.shotCount(); i < count; ++i) {
+            GameLog::ShotEntry shot = game.shot(i);
+            shots[shot.side]++;
+            hits[shot.side] += shot.result.hit();
+        }
+        games++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("games:         %llu scanned in %.3f s (%.0f games/s)\n",
+                static_cast<unsigned long long>(games), seconds, games / std::max(seconds, 1e-9));
+    for (int side = 0; side < 2; ++side) {
+        if (shots[side] == 0) continue;
+        std::printf("side %d:        %.2f shots per game, %.1f%% hits\n", side,
+                    double(shots[side]) / games, 100.0 * hits[side] / shots[side]);
+    }
+    return 0;
+}
+
+int percentile(const std::array<std::uint64_t, BattleshipBoard::CELL_COUNT + 1>& histogram,
+               std::uint64_t total, double fraction)
+{
+    std::uint64_t seen = 0;
+    for (int shots = 0; shots <= BattleshipBoard::CELL_COUNT; ++shots) {
+        seen += histogram[shots];
+        if (seen > 0 && seen >= fraction * total) return shots;
+    }
+    return BattleshipBoard::CELL_COUNT;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::uint64_t games = 100000;
+    int threads = 0;
+    std::uint64_t seed = std::random_device{}();
+    Settings settings;
+    GameLogWriter log;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--games") && hasValue) {
+            games = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--seed") && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--scan") && hasValue) {
+            return scanLog(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--log") && hasValue) {
+            if (!log.open(QString::fromLocal8Bit(argv[++i]))) {
+                std::fprintf(stderr, "cannot open game log: %s\n", argv[i]);
+                return 1;
+            }
+            settings.log = &log;
+        } else if (!std::strcmp(argv[i], "--budget-us") && hasValue) {
+            settings.budget = std::chrono::microseconds(std::atoll(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--sampler-threads") && hasValue) {
+            settings.samplerThreads = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--salvo") && hasValue) {
+            settings.salvo = std::max(0, std::min(SalvoResult::MAX_SHOTS, std::atoi(argv[++i])));
+        } else if (!std::strcmp(argv[i], "--strategy") && hasValue) {
+            std::string name = argv[++i];
+            if (name == "density") settings.strategy = AIPlayer::Density;
+            else if (name == "hunt") settings.strategy = AIPlayer::HuntTarget;
+            else if (name == "montecarlo") settings.strategy = AIPlayer::MonteCarlo;
+            else if (name == "background") settings.strategy = AIPlayer::BackgroundDensity;
+            else {
+                std::fprintf(stderr, "unknown strategy: %s\n", name.c_str());
+                return 1;
+            }
+        } else {
+            std::fprintf(stderr, "usage: %s [--games N] [--threads T] "
+                                 "[--strategy density|hunt|montecarlo|background] [--budget-us U] "
+                                 "[--sampler-threads K] [--salvo K] [--seed S] [--log FILE]\n"
+                                 "       %s --scan FILE\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    WorkStealingPool pool(threads);
+    std::vector<WorkerStats> stats(pool.threadCount());
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t task = 0;
+    for (std::uint64_t first = 0; first < games; first += GAMES_PER_TASK, ++task) {
+        int count = static_cast<int>(std::min<std::uint64_t>(GAMES_PER_TASK, games - first));
+        std::uint64_t taskSeed = seed + task * 0x9E3779B97F4A7C15ULL;
+        pool.submit([&pool, &stats, &settings, count, taskSeed] {
+            playGames(count, taskSeed, settings, stats[pool.currentWorker()]);
+        });
+    }
+    pool.wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WorkerStats total;
+    for (const WorkerStats& worker : stats) {
+        for (size_t i = 0; i < total.shots.size(); ++i) total.shots[i] += worker.shots[i];
+        for (size_t i = 0; i < total.latency.size(); ++i) total.latency[i] += worker.latency[i];
+        total.games += worker.games;
+        total.moves += worker.moves;
+        total.latencyNs += worker.latencyNs;
+    }
+
+    double shotSum = 0;
+    for (int shots = 0; shots <= BattleshipBoard::CELL_COUNT; ++shots) {
+        shotSum += double(shots) * total.shots[shots];
+    }
+
+    const char* strategyNames[] = {"hunt", "density", "montecarlo", "background"};
+    std::printf("strategy:      %s\n", strategyNames[settings.strategy]);
+    std::printf("threads:       %d\n", pool.threadCount());
+    std::printf("seed:          %llu\n", static_cast<unsigned long long>(seed));
+    std::printf("games:         %llu in %.2f s (%.0f games/s)\n",
+                static_cast<unsigned long long>(total.games), seconds, total.games / seconds);
+    if (settings.salvo > 0) {
+        std::printf("salvo:         %d shots\n", settings.salvo);
+    }
+    if (total.games == 0) {
+        return 0;
+    }
+    std::printf("%s mean %.2f  p50 %d  p90 %d  p99 %d  max %d\n",
+                settings.salvo > 0 ? "volleys to win:" : "shots to win: ",
+                shotSum / total.games,
+                percentile(total.shots, total.games, 0.50),
+                percentile(total.shots, total.games, 0.90),
+                percentile(total.shots, total.games, 0.99),
+                percentile(total.shots, total.games, 1.0));
+    std::printf("move latency:  mean %.0f ns over %llu %s\n",
+                total.latencyNs / total.moves, static_cast<unsigned long long>(total.moves),
+                settings.salvo > 0 ? "volleys" : "moves");
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        if (total.latency[bucket] == 0) continue;
+        std::printf("  < %9lld ns  %12llu  %6.2f%%\n",
+                    1LL << (bucket + 1),
+                    static_cast<unsigned long long>(total.latency[bucket]),
+                    100.0 * total.latency[bucket] / total.moves);
+    }
+    return 0;
+}
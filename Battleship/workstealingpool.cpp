@@ -0,0 +1,118 @@
+#include "workstealingpool.h"
+
+namespace {
+// Пулов может быть несколько, и задача одного может ставить задачи в другой:
+// номер потока действителен только для пула, которому поток принадлежит
+thread_local const WorkStealingPool* workerPool = nullptr;
+thread_local int workerIndex = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int threads)
+    : queued(0), unfinished(0), nextQueue(0), stopping(false)
+{
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) threads = 1;
+    }
+    for (int i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int WorkStealingPool::currentWorker() const
+{
+    return workerPool == this ? workerIndex : -1;
+}
+
+void WorkStealingPool::submit(std::function<void()> task)
+{
+    // Задачи, порождённые внутри пула, остаются в очереди своего потока
+    int index = currentWorker();
+    if (index < 0) {
+        index = static_cast<int>(nextQueue++ % queues.size());
+    }
+    unfinished++;
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queued++;
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this] { return unfinished == 0; });
+}
+
+bool WorkStealingPool::takeTask(int index, std::function<void()>& task)
+{
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+        Queue& victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int index)
+{
+    workerPool = this;
+    workerIndex = index;
+    std::function<void()> task;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            workAvailable.wait(lock, [this] { return stopping || queued > 0; });
+            if (queued == 0) {
+                return;
+            }
+            // Задача закрепляется за потоком до поиска, иначе остальные разбуженные
+            // потоки крутились бы вхолостую, пока взятая задача ещё числится в queued
+            queued--;
+        }
+        // Задача уже лежит в одной из очередей, но её могут на миг перехватить
+        // другие потоки, закрепившие свои задачи позже
+        while (!takeTask(index, task)) {
+            std::this_thread::yield();
+        }
+        task();
+        task = nullptr;
+        if (--unfinished == 0) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            allDone.notify_all();
+        }
+    }
+}
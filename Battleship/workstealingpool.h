@@ -0,0 +1,51 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с собственной очередью у каждого потока: поток берёт задачи
+// с конца своей очереди, а когда она пуста - крадёт с начала чужих
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    int threadCount() const { return static_cast<int>(workers.size()); }
+    // Номер потока этого пула, выполняющего текущую задачу, -1 вне него
+    int currentWorker() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    std::atomic<int> queued;
+    std::atomic<int> unfinished;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+
+    void workerLoop(int index);
+    bool takeTask(int index, std::function<void()>& task);
+};
+
+#endif
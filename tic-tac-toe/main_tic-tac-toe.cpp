@@ -6,6 +6,38 @@
 #include <ctime>
 #include <QProcess>
 #include <QCoreApplication>
+#include <QMetaObject>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+struct BoardPreset {
+    const char *name;
+    int rows, cols, winLength;
+};
+
+const BoardPreset BOARD_PRESETS[] = {
+    {"3x3", 3, 3, 3},
+    {"4x4", 4, 4, 4},
+    {"Гомоку 15x15", 15, 15, 5},
+    {"Гомоку 19x19", 19, 19, 5},
+};
+
+// Подсветка лучших ходов; по ней же отличаем свои клетки от линии победы
+const char *const BEST_MOVE_STYLE = "background-color: lightgreen";
+
+const std::chrono::milliseconds AI_THINK_TIME(1000);
+const std::chrono::milliseconds ULTIMATE_THINK_TIME(500);
+
+// Тройки малых досок, выигрыш которых выигрывает Ultimate
+const int ULTIMATE_LINES[8][3] = {
+    {0,1,2}, {3,4,5}, {6,7,8},
+    {0,3,6}, {1,4,7}, {2,5,8},
+    {0,4,8}, {2,4,6}
+};
+
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -13,7 +45,10 @@ MainWindow::MainWindow(QWidget *parent)
       buttons(3, QVector<QPushButton*>(3, nullptr)),
       currentPlayer(Player::X),
       vsAI(true),
-      startingPlayer(Player::X)
+      startingPlayer(Player::X),
+      rows(3), cols(3), winLength(3),
+      variant(Variant::Mnk),
+      aiGeneration(0)
 
 {
     QWidget *central = new QWidget;
@@ -30,6 +65,10 @@ MainWindow::MainWindow(QWidget *parent)
     modeCombo = new QComboBox;
     modeCombo->addItem("Игрок vs AI");
     modeCombo->addItem("Игрок vs Игрок");
+    modeCombo->addItem("Ultimate: Игрок vs AI");
+    modeCombo->addItem("Ultimate: Игрок vs Игрок");
+    modeCombo->addItem("Qubic: Игрок vs AI");
+    modeCombo->addItem("Qubic: Игрок vs Игрок");
     connect(modeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onModeChanged);
 
     difficultyCombo = new QComboBox;
@@ -39,25 +78,26 @@ MainWindow::MainWindow(QWidget *parent)
 
     aiDifficulty = difficultyCombo->currentIndex();
 
+    boardCombo = new QComboBox;
+    for (const BoardPreset& preset : BOARD_PRESETS)
+        boardCombo->addItem(preset.name);
+    connect(boardCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onBoardChanged);
+
     restartBtn = new QPushButton("Рестарт");
     connect(restartBtn, &QPushButton::clicked, this, &MainWindow::restartGame);
 
+    bestMovesBtn = new QPushButton("Лучшие ходы");
+    bestMovesBtn->setCheckable(true);
+    connect(bestMovesBtn, &QPushButton::toggled, this, &MainWindow::updateBestMoves);
+
     topBar->addWidget(modeCombo);
     topBar->addWidget(difficultyCombo);
+    topBar->addWidget(boardCombo);
     topBar->addWidget(restartBtn);
+    topBar->addWidget(bestMovesBtn);
 
-    QGridLayout *grid = new QGridLayout;
-    QFont btnFont;
-    btnFont.setPointSize(32);
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j) {
-            QPushButton *btn = new QPushButton;
-            btn->setFixedSize(100, 100);
-            btn->setFont(btnFont);
-            grid->addWidget(btn, i, j);
-            buttons[i][j] = btn;
-            connect(btn, &QPushButton::clicked, [=]{ handleButton(i, j); });
-        }
+    grid = new QGridLayout;
+    buildBoard();
 
     statusLabel = new QLabel("Ваш ход (X)");
     statusLabel->setAlignment(Qt::AlignCenter);
@@ -73,16 +113,92 @@ MainWindow::MainWindow(QWidget *parent)
     setCentralWidget(central);
     setWindowTitle("Крестики-нолики");
 
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    engine.setThreads(threads);
+    ultimateEngine.setThreads(threads);
+
     srand(time(0));
     restartGame();
 }
 
+MainWindow::~MainWindow() {
+    ++aiGeneration;
+    stopEngine();
+}
+
+void MainWindow::buildBoard() {
+    for (auto& row : buttons)
+        for (QPushButton *btn : row)
+            delete btn;
+
+    // Большие доски не влезут в экран с клетками 100x100
+    int cellSize = 32, fontSize = 14, spacing = 1;
+    if (variant != Variant::Mnk) {
+        cellSize = 52; fontSize = 20; spacing = 2;
+    } else if (rows <= 4) {
+        cellSize = 100; fontSize = 32; spacing = 6;
+    }
+    QFont btnFont;
+    btnFont.setPointSize(fontSize);
+    grid->setSpacing(spacing);
+
+    // Малые доски Ultimate и слои Qubic разделены пустыми строками и столбцами
+    int blockRows = (variant == Variant::Ultimate) ? 3 : rows;
+    int blockCols = (variant == Variant::Ultimate) ? 3 : (variant == Variant::Qubic ? 4 : cols);
+    for (int k = 0; k < grid->rowCount(); ++k)
+        grid->setRowMinimumHeight(k, 0);
+    for (int k = 0; k < grid->columnCount(); ++k)
+        grid->setColumnMinimumWidth(k, 0);
+    for (int k = 1; k * blockRows < rows; ++k)
+        grid->setRowMinimumHeight(k * (blockRows + 1) - 1, 10);
+    for (int k = 1; k * blockCols < cols; ++k)
+        grid->setColumnMinimumWidth(k * (blockCols + 1) - 1, 10);
+
+    buttons = QVector<QVector<QPushButton*>>(rows, QVector<QPushButton*>(cols, nullptr));
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j) {
+            QPushButton *btn = new QPushButton;
+            btn->setFixedSize(cellSize, cellSize);
+            btn->setFont(btnFont);
+            grid->addWidget(btn, i + i / blockRows, j + j / blockCols);
+            buttons[i][j] = btn;
+            connect(btn, &QPushButton::clicked, [=]{ handleButton(i, j); });
+        }
+}
+
+void MainWindow::placeMark(int row, int col) {
+    board[row][col] = currentPlayer;
+    buttons[row][col]->setText(currentPlayer == Player::X ? "X" : "O");
+    int cell = boardCell(row, col);
+    switch (variant) {
+    case Variant::Mnk: position.play(cell); break;
+    case Variant::Ultimate: ultimatePosition.play(cell); break;
+    case Variant::Qubic: qubicPosition.play(cell); break;
+    }
+}
+
+int MainWindow::boardCell(int row, int col) const {
+    switch (variant) {
+    case Variant::Ultimate: return (row / 3 * 3 + col / 3) * 9 + row % 3 * 3 + col % 3;
+    case Variant::Qubic: return col / 4 * 16 + row * 4 + col % 4;
+    default: return row * cols + col;
+    }
+}
+
+QPair<int,int> MainWindow::cellButton(int cell) const {
+    switch (variant) {
+    case Variant::Ultimate: return {cell / 27 * 3 + cell % 9 / 3, cell / 9 % 3 * 3 + cell % 3};
+    case Variant::Qubic: return {cell / 4 % 4, cell / 16 * 4 + cell % 4};
+    default: return {cell / cols, cell % cols};
+    }
+}
+
 void MainWindow::handleButton(int row, int col) {
     if (board[row][col] != Player::None) return;
     if (vsAI && currentPlayer == Player::O) return;
+    if (variant == Variant::Ultimate && !ultimatePosition.isLegal(boardCell(row, col))) return;
 
-    board[row][col] = currentPlayer;
-    buttons[row][col]->setText(currentPlayer == Player::X ? "X" : "O");
+    placeMark(row, col);
 
     if (checkGameOver()) return;
 
@@ -94,10 +210,15 @@ void MainWindow::handleButton(int row, int col) {
 void MainWindow::aiMove() {
     if (isBoardFull() || checkWin(Player::X) || checkWin(Player::O)) return;
 
-    if (aiDifficulty == 0)
+    if (aiDifficulty == 0) {
         makeAIMoveRandom();
-    else
-        makeAIMoveMinimax();
+    } else if (isClassic()) {
+        makeAIMovePerfect();
+    } else {
+        // Ход придёт из потока поиска, там же и проверка конца партии
+        makeAIMoveEngine();
+        return;
+    }
 
     if (checkGameOver()) return;
 }
@@ -124,30 +245,72 @@ bool MainWindow::checkGameOver() {
 }
 
 bool MainWindow::checkWin(Player p, QVector<QPair<int,int>>* winLine) {
-    for (int i=0; i<3; ++i) {
-        if (board[i][0]==p && board[i][1]==p && board[i][2]==p) {
-            if (winLine) *winLine = {{i,0},{i,1},{i,2}};
-            return true;
-        }
-        if (board[0][i]==p && board[1][i]==p && board[2][i]==p) {
-            if (winLine) *winLine = {{0,i},{1,i},{2,i}};
-            return true;
+    if (variant == Variant::Ultimate) return checkUltimateWin(p, winLine);
+    if (variant == Variant::Qubic) return checkQubicWin(p, winLine);
+    const int directions[4][2] = {{0,1}, {1,0}, {1,1}, {1,-1}};
+    for (int i=0; i<rows; ++i)
+        for (int j=0; j<cols; ++j)
+            for (auto& d : directions) {
+                int length = 0;
+                while (length < winLength) {
+                    int r = i + d[0]*length, c = j + d[1]*length;
+                    if (r < 0 || r >= rows || c < 0 || c >= cols || board[r][c] != p) break;
+                    ++length;
+                }
+                if (length < winLength) continue;
+                if (winLine) {
+                    winLine->clear();
+                    for (int s=0; s<winLength; ++s)
+                        winLine->append({i + d[0]*s, j + d[1]*s});
+                }
+                return true;
+            }
+    return false;
+}
+
+bool MainWindow::checkUltimateWin(Player p, QVector<QPair<int,int>>* winLine) {
+    int side = (p == Player::X) ? UltimatePosition::X : UltimatePosition::O;
+    if (ultimatePosition.winner() != side) return false;
+    if (winLine) {
+        // Подсвечиваются камни победителя на трёх выигранных досках
+        winLine->clear();
+        for (auto& line : ULTIMATE_LINES) {
+            if (ultimatePosition.boardWinner(line[0]) != side ||
+                ultimatePosition.boardWinner(line[1]) != side ||
+                ultimatePosition.boardWinner(line[2]) != side) continue;
+            for (int i=0; i<rows; ++i)
+                for (int j=0; j<cols; ++j) {
+                    int cell = boardCell(i, j);
+                    if (std::find(std::begin(line), std::end(line), cell / 9) != std::end(line) &&
+                        ultimatePosition.at(cell) == side)
+                        winLine->append({i, j});
+                }
+            break;
         }
     }
-    if (board[0][0]==p && board[1][1]==p && board[2][2]==p) {
-        if (winLine) *winLine = {{0,0},{1,1},{2,2}};
-        return true;
-    }
-    if (board[0][2]==p && board[1][1]==p && board[2][0]==p) {
-        if (winLine) *winLine = {{0,2},{1,1},{2,0}};
+    return true;
+}
+
+bool MainWindow::checkQubicWin(Player p, QVector<QPair<int,int>>* winLine) {
+    std::uint64_t stones = qubicPosition.mask(p == Player::X ? QubicPosition::X : QubicPosition::O);
+    for (std::uint64_t line : QubicPosition::lines()) {
+        if ((stones & line) != line) continue;
+        if (winLine) {
+            winLine->clear();
+            for (int cell=0; cell<QubicPosition::CELLS; ++cell)
+                if (line >> cell & 1)
+                    winLine->append(cellButton(cell));
+        }
         return true;
     }
     return false;
 }
 
 bool MainWindow::isBoardFull() {
-    for (int i=0; i<3; ++i)
-        for (int j=0; j<3; ++j)
+    // В Ultimate ходов нет, когда все малые доски выиграны или заполнены
+    if (variant == Variant::Ultimate) return ultimatePosition.over();
+    for (int i=0; i<rows; ++i)
+        for (int j=0; j<cols; ++j)
             if (board[i][j] == Player::None)
                 return false;
     return true;
@@ -161,6 +324,49 @@ void MainWindow::updateStatus() {
         msg = (currentPlayer == Player::X) ? "Ходит игрок X" : "Ходит игрок O";
     }
     statusLabel->setText(msg);
+    updateBestMoves();
+    updateUltimateBoards();
+}
+
+int MainWindow::positionKey() const {
+    int key = 0;
+    for (int i=0; i<3; ++i)
+        for (int j=0; j<3; ++j)
+            if (board[i][j] != Player::None)
+                key += PerfectPlay::POW3[i*3 + j] * (board[i][j] == Player::X ? PerfectPlay::X : PerfectPlay::O);
+    return key;
+}
+
+void MainWindow::updateBestMoves() {
+    // Таблица есть только для классической доски
+    if (!isClassic()) return;
+    int side = (currentPlayer == Player::X) ? PerfectPlay::X : PerfectPlay::O;
+    std::uint16_t moves = bestMovesBtn->isChecked() ? PerfectPlay::lookup(positionKey(), side).bestMoves : 0;
+    for (int cell=0; cell<PerfectPlay::CELLS; ++cell) {
+        QPushButton *button = buttons[cell / 3][cell % 3];
+        if (moves >> cell & 1)
+            button->setStyleSheet(BEST_MOVE_STYLE);
+        else if (button->styleSheet() == BEST_MOVE_STYLE)
+            button->setStyleSheet("");
+    }
+}
+
+void MainWindow::updateUltimateBoards() {
+    if (variant != Variant::Ultimate) return;
+    // Выигранные доски - цветом хозяина, доски для следующего хода - голубым
+    for (int i=0; i<rows; ++i)
+        for (int j=0; j<cols; ++j) {
+            int cell = boardCell(i, j);
+            int owner = ultimatePosition.boardWinner(cell / 9);
+            const char *style = "";
+            if (owner == UltimatePosition::X)
+                style = "background-color: khaki";
+            else if (owner == UltimatePosition::O)
+                style = "background-color: lightpink";
+            else if (ultimatePosition.isLegal(cell))
+                style = "background-color: lightblue";
+            buttons[i][j]->setStyleSheet(style);
+        }
 }
 
 void MainWindow::showEndScreen(QString message) {
@@ -169,13 +375,21 @@ void MainWindow::showEndScreen(QString message) {
 }
 
 void MainWindow::restartGame() {
-    board = QVector<QVector<Player>>(3, QVector<Player>(3, Player::None));
-    for (int i=0; i<3; ++i)
-        for (int j=0; j<3; ++j) {
+    ++aiGeneration;
+    stopEngine();
+
+    board = QVector<QVector<Player>>(rows, QVector<Player>(cols, Player::None));
+    for (int i=0; i<rows; ++i)
+        for (int j=0; j<cols; ++j) {
             buttons[i][j]->setText("");
             buttons[i][j]->setStyleSheet("");
         }
     currentPlayer = startingPlayer;
+    position = MnkPosition(rows, cols, winLength, currentPlayer == Player::X ? MnkPosition::X : MnkPosition::O);
+    ultimatePosition = UltimatePosition(currentPlayer == Player::X ? UltimatePosition::X : UltimatePosition::O);
+    qubicPosition = QubicPosition(currentPlayer == Player::X ? QubicPosition::X : QubicPosition::O);
+    qubicEngine.clear();
+    engine.clear();
     updateStatus();
 
     startingPlayer = (startingPlayer == Player::X) ? Player::O : Player::X;
@@ -187,8 +401,25 @@ void MainWindow::restartGame() {
 
 
 void MainWindow::onModeChanged(int idx) {
-    vsAI = (idx == 0);
-    restartGame();
+    // Режимы парами: против AI и вдвоём для каждого варианта
+    vsAI = (idx % 2 == 0);
+    Variant previous = variant;
+    variant = (idx < 2) ? Variant::Mnk : (idx < 4 ? Variant::Ultimate : Variant::Qubic);
+    boardCombo->setEnabled(variant == Variant::Mnk);
+    if (variant == previous) {
+        restartGame();
+    } else if (variant != Variant::Mnk) {
+        rows = (variant == Variant::Ultimate) ? 9 : 4;
+        cols = (variant == Variant::Ultimate) ? 9 : 16;
+        winLength = (variant == Variant::Ultimate) ? 3 : 4;
+        bestMovesBtn->setChecked(false);
+        bestMovesBtn->setEnabled(false);
+        buildBoard();
+        adjustSize();
+        restartGame();
+    } else {
+        onBoardChanged(boardCombo->currentIndex());
+    }
 }
 
 void MainWindow::onDifficultyChanged(int idx) {
@@ -196,65 +427,77 @@ void MainWindow::onDifficultyChanged(int idx) {
     restartGame();
 }
 
+void MainWindow::onBoardChanged(int idx) {
+    rows = BOARD_PRESETS[idx].rows;
+    cols = BOARD_PRESETS[idx].cols;
+    winLength = BOARD_PRESETS[idx].winLength;
+    bestMovesBtn->setChecked(false);
+    bestMovesBtn->setEnabled(isClassic());
+    buildBoard();
+    adjustSize();
+    restartGame();
+}
+
 void MainWindow::makeAIMoveRandom() {
     QVector<QPair<int,int>> freeCells;
-    for (int i=0; i<3; ++i)
-        for (int j=0; j<3; ++j)
-            if (board[i][j] == Player::None)
+    for (int i=0; i<rows; ++i)
+        for (int j=0; j<cols; ++j)
+            if (board[i][j] == Player::None && (variant != Variant::Ultimate || ultimatePosition.isLegal(boardCell(i, j))))
                 freeCells.append({i,j});
     if (!freeCells.isEmpty()) {
         auto move = freeCells[rand() % freeCells.size()];
-        board[move.first][move.second] = Player::O;
-        buttons[move.first][move.second]->setText("O");
+        placeMark(move.first, move.second);
     }
 }
 
-void MainWindow::makeAIMoveMinimax() {
-    bool empty = true;
-    for (int i=0; i<3 && empty; ++i)
-        for (int j=0; j<3 && empty; ++j)
-            if (board[i][j] != Player::None)
-                empty = false;
-    if (empty) {
-        QVector<QPair<int,int>> bestStarts = {{0,0},{0,2},{2,0},{2,2},{1,1}};
-        auto move = bestStarts[rand() % bestStarts.size()];
-        board[move.first][move.second] = Player::O;
-        buttons[move.first][move.second]->setText("O");
-        return;
-    }
-    int bestRow = -1, bestCol = -1;
-    minimax(Player::O, 0, bestRow, bestCol);
-    if (bestRow >= 0 && bestCol >= 0) {
-        board[bestRow][bestCol] = Player::O;
-        buttons[bestRow][bestCol]->setText("O");
+void MainWindow::makeAIMovePerfect() {
+    // Все ходы с лучшей оценкой равноценны, среди них выбирается случайный
+    std::uint16_t moves = PerfectPlay::lookup(positionKey(), PerfectPlay::O).bestMoves;
+    QVector<int> cells;
+    for (int cell=0; cell<PerfectPlay::CELLS; ++cell)
+        if (moves >> cell & 1)
+            cells.append(cell);
+    if (!cells.isEmpty()) {
+        int cell = cells[rand() % cells.size()];
+        placeMark(cell / 3, cell % 3);
     }
 }
 
+void MainWindow::makeAIMoveEngine() {
+    stopEngine();
+    // Снимается здесь, а не в потоке: рестарт до начала поиска должен его остановить
+    engine.resume();
+    ultimateEngine.resume();
+    qubicEngine.resume();
+    statusLabel->setText("AI думает...");
+
+    // Поиск идёт в своём потоке, чтобы окно не замирало; пока он не ответил,
+    // currentPlayer == O и клики по доске игнорируются
+    int generation = aiGeneration;
+    Variant searched = variant;
+    MnkPosition root = position;
+    UltimatePosition ultimateRoot = ultimatePosition;
+    QubicPosition qubicRoot = qubicPosition;
+    aiThread = std::thread([this, root, ultimateRoot, qubicRoot, searched, generation] {
+        int move = -1;
+        switch (searched) {
+        case Variant::Mnk: move = engine.search(root, AI_THINK_TIME).move; break;
+        case Variant::Ultimate: move = ultimateEngine.search(ultimateRoot, ULTIMATE_THINK_TIME).move; break;
+        case Variant::Qubic: move = qubicEngine.search(qubicRoot, AI_THINK_TIME).move; break;
+        }
+        QMetaObject::invokeMethod(this, [this, move, generation] {
+            if (generation != aiGeneration || move < 0) return;
+            QPair<int,int> button = cellButton(move);
+            placeMark(button.first, button.second);
+            checkGameOver();
+        }, Qt::QueuedConnection);
+    });
+}
 
-int MainWindow::minimax(Player current, int depth, int &bestRow, int &bestCol) {
-    if (checkWin(Player::O)) return 10 - depth;
-    if (checkWin(Player::X)) return depth - 10;
-    if (isBoardFull()) return 0;
-
-    int bestScore = (current == Player::O) ? -1000 : 1000;
-    for (int i=0; i<3; ++i)
-        for (int j=0; j<3; ++j)
-            if (board[i][j] == Player::None) {
-                board[i][j] = current;
-                int r, c;
-                int score = minimax((current == Player::O) ? Player::X : Player::O, depth+1, r, c);
-                board[i][j] = Player::None;
-                if (current == Player::O) {
-                    if (score > bestScore) {
-                        bestScore = score;
-                        if (depth == 0) { bestRow = i; bestCol = j; }
-                    }
-                } else {
-                    if (score < bestScore) {
-                        bestScore = score;
-                        if (depth == 0) { bestRow = i; bestCol = j; }
-                    }
-                }
-            }
-    return bestScore;
+void MainWindow::stopEngine() {
+    if (!aiThread.joinable()) return;
+    engine.stop();
+    ultimateEngine.stop();
+    qubicEngine.stop();
+    aiThread.join();
 }
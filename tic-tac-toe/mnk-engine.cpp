@@ -0,0 +1,405 @@
+#include "mnk-engine.h"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+namespace {
+
+constexpr int ZOBRIST_KEYS = MnkPosition::MAX_SIZE * MnkPosition::MAX_SIZE * 2 + 1;
+
+// Ключ клетки для X, для O и последний ключ - смена очереди хода
+const std::array<std::uint64_t, ZOBRIST_KEYS>& zobristKeys() {
+    static const std::array<std::uint64_t, ZOBRIST_KEYS> keys = [] {
+        std::array<std::uint64_t, ZOBRIST_KEYS> result{};
+        std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (auto& key : result) {
+            // splitmix64
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            key = z ^ (z >> 31);
+        }
+        return result;
+    }();
+    return keys;
+}
+
+// Границы для moveValue: выигрывающий ход и ход, без которого соперник выигрывает
+constexpr int WINNING_MOVE = 1 << 30;
+constexpr int FORCED_BLOCK = 1 << 28;
+
+// На больших досках в глубине смотрятся только лучшие по moveValue ходы
+constexpr int SMALL_BOARD = 25;
+constexpr int MAX_BRANCH = 12;
+
+}
+
+MnkPosition::MnkPosition(int rows, int cols, int k, int first)
+    : geometry(makeGeometry(rows, cols, k)),
+      cells(geometry->rows * geometry->cols, EMPTY),
+      near(geometry->rows * geometry->cols, 0),
+      windowCounts(geometry->windowCells.size() / geometry->k, {0, 0}),
+      completed{0, 0, 0},
+      side(first),
+      stones(0),
+      score(0),
+      key(first == O ? zobristKeys()[ZOBRIST_KEYS - 1] : 0) {
+}
+
+std::shared_ptr<const MnkPosition::Geometry> MnkPosition::makeGeometry(int rows, int cols, int k) {
+    auto geometry = std::make_shared<Geometry>();
+    rows = std::max(1, std::min(rows, MAX_SIZE));
+    cols = std::max(1, std::min(cols, MAX_SIZE));
+    k = std::max(1, std::min(k, std::max(rows, cols)));
+    geometry->rows = rows;
+    geometry->cols = cols;
+    geometry->k = k;
+
+    // Вправо, вниз, вниз-вправо, вниз-влево
+    const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    std::vector<std::vector<int>> perCell(rows * cols);
+    for (int row = 0; row < rows; ++row)
+        for (int col = 0; col < cols; ++col)
+            for (const auto& dir : directions) {
+                int endRow = row + dir[0] * (k - 1);
+                int endCol = col + dir[1] * (k - 1);
+                if (endRow < 0 || endRow >= rows || endCol < 0 || endCol >= cols) continue;
+                int window = static_cast<int>(geometry->windowCells.size()) / k;
+                for (int i = 0; i < k; ++i) {
+                    int cell = (row + dir[0] * i) * cols + col + dir[1] * i;
+                    geometry->windowCells.push_back(cell);
+                    perCell[cell].push_back(window);
+                }
+            }
+
+    geometry->cellWindowStart.push_back(0);
+    for (const auto& windows : perCell) {
+        geometry->cellWindows.insert(geometry->cellWindows.end(), windows.begin(), windows.end());
+        geometry->cellWindowStart.push_back(static_cast<int>(geometry->cellWindows.size()));
+    }
+
+    // Окно с c камнями одного цвета весит в 8 раз больше, чем с c - 1
+    for (int count = 0; count <= k; ++count)
+        geometry->weights.push_back(count == 0 ? 0 : 1 << std::min(3 * (count - 1), 24));
+    return geometry;
+}
+
+int MnkPosition::windowScore(int window) const {
+    const auto& counts = windowCounts[window];
+    if (counts[0] && counts[1]) return 0;
+    return geometry->weights[counts[0]] - geometry->weights[counts[1]];
+}
+
+void MnkPosition::play(int cell) {
+    const int k = geometry->k;
+    const int own = side - 1;
+    for (int i = geometry->cellWindowStart[cell]; i < geometry->cellWindowStart[cell + 1]; ++i) {
+        int window = geometry->cellWindows[i];
+        score -= windowScore(window);
+        if (++windowCounts[window][own] == k) completed[side]++;
+        score += windowScore(window);
+    }
+
+    const int rows = geometry->rows, cols = geometry->cols;
+    int row = cell / cols, col = cell % cols;
+    for (int r = std::max(0, row - 2); r <= std::min(rows - 1, row + 2); ++r)
+        for (int c = std::max(0, col - 2); c <= std::min(cols - 1, col + 2); ++c)
+            near[r * cols + c]++;
+
+    const auto& keys = zobristKeys();
+    key ^= keys[cell * 2 + own] ^ keys[ZOBRIST_KEYS - 1];
+    cells[cell] = static_cast<std::uint8_t>(side);
+    stones++;
+    side = X + O - side;
+}
+
+void MnkPosition::undo(int cell) {
+    side = X + O - side;
+    stones--;
+    cells[cell] = EMPTY;
+    const int own = side - 1;
+    const auto& keys = zobristKeys();
+    key ^= keys[cell * 2 + own] ^ keys[ZOBRIST_KEYS - 1];
+
+    const int rows = geometry->rows, cols = geometry->cols;
+    int row = cell / cols, col = cell % cols;
+    for (int r = std::max(0, row - 2); r <= std::min(rows - 1, row + 2); ++r)
+        for (int c = std::max(0, col - 2); c <= std::min(cols - 1, col + 2); ++c)
+            near[r * cols + c]--;
+
+    const int k = geometry->k;
+    for (int i = geometry->cellWindowStart[cell]; i < geometry->cellWindowStart[cell + 1]; ++i) {
+        int window = geometry->cellWindows[i];
+        score -= windowScore(window);
+        if (windowCounts[window][own]-- == k) completed[side]--;
+        score += windowScore(window);
+    }
+}
+
+void MnkPosition::candidates(std::vector<int>& moves) const {
+    moves.clear();
+    const int count = cellCount();
+    if (stones == 0 && count > SMALL_BOARD) {
+        moves.push_back((geometry->rows / 2) * geometry->cols + geometry->cols / 2);
+        return;
+    }
+    for (int cell = 0; cell < count; ++cell)
+        if (cells[cell] == EMPTY && (near[cell] || count <= SMALL_BOARD))
+            moves.push_back(cell);
+}
+
+int MnkPosition::moveValue(int cell) const {
+    const int k = geometry->k;
+    const int own = side - 1, other = 2 - side;
+    bool blocks = false;
+    int value = 0;
+    for (int i = geometry->cellWindowStart[cell]; i < geometry->cellWindowStart[cell + 1]; ++i) {
+        const auto& counts = windowCounts[geometry->cellWindows[i]];
+        if (!counts[other]) {
+            if (counts[own] == k - 1) return WINNING_MOVE;
+            value += 2 * geometry->weights[counts[own] + 1];
+        }
+        if (!counts[own]) {
+            blocks = blocks || counts[other] == k - 1;
+            value += geometry->weights[counts[other] + 1];
+        }
+    }
+    return blocks ? FORCED_BLOCK + value : value;
+}
+
+MnkEngine::MnkEngine(int tableBits, int threads)
+    : table(std::size_t(1) << tableBits),
+      stopRequested(false),
+      aborted(false) {
+    setThreads(threads);
+}
+
+void MnkEngine::setThreads(int count) {
+    workers.resize(std::max(1, std::min(count, MAX_THREADS)));
+    clear();
+}
+
+void MnkEngine::clear() {
+    for (Entry& entry : table) {
+        entry.check.store(0, std::memory_order_relaxed);
+        entry.data.store(0, std::memory_order_relaxed);
+    }
+    for (Worker& worker : workers) {
+        worker.history.assign(MnkPosition::MAX_SIZE * MnkPosition::MAX_SIZE, 0);
+        for (auto& slot : worker.killers) slot = {-1, -1};
+        worker.moveLists.resize(MAX_PLY);
+        worker.scoredLists.resize(MAX_PLY);
+    }
+}
+
+// data: счёт в младших 32 битах, затем ход (16), глубина (8) и тип оценки (8)
+bool MnkEngine::probe(std::uint64_t key, Stored& stored) const {
+    const Entry& entry = table[key & (table.size() - 1)];
+    std::uint64_t data = entry.data.load(std::memory_order_relaxed);
+    if ((entry.check.load(std::memory_order_relaxed) ^ data) != key) return false;
+    stored.score = static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+    stored.move = static_cast<std::int16_t>(data >> 32);
+    stored.depth = static_cast<std::int8_t>(data >> 48);
+    stored.bound = static_cast<std::uint8_t>(data >> 56);
+    return true;
+}
+
+void MnkEngine::store(std::uint64_t key, int score, int move, int depth, Bound bound) {
+    std::uint64_t data = static_cast<std::uint32_t>(score)
+        | std::uint64_t(static_cast<std::uint16_t>(move)) << 32
+        | std::uint64_t(static_cast<std::uint8_t>(depth)) << 48
+        | std::uint64_t(bound) << 56;
+    Entry& entry = table[key & (table.size() - 1)];
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
+
+bool MnkEngine::timeUp() {
+    if (std::chrono::steady_clock::now() >= deadline) aborted = true;
+    return aborted;
+}
+
+void MnkEngine::orderMoves(Worker& worker, const MnkPosition& position, std::vector<int>& moves, int ttMove, int ply) {
+    std::vector<std::pair<int, int>>& scored = worker.scoredLists[ply];
+    scored.clear();
+    for (int move : moves) {
+        int value = position.moveValue(move);
+        // Ход из таблицы, убийцы и история не должны дотянуть до вынужденных ходов
+        if (value < FORCED_BLOCK) {
+            if (move == worker.killers[ply][0] || move == worker.killers[ply][1]) value += position.weight(position.winLength() - 1);
+            value = std::min(value + worker.history[move], FORCED_BLOCK - 2);
+            if (move == ttMove) value = FORCED_BLOCK - 1;
+        }
+        scored.push_back({value, move});
+    }
+    std::sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    // Есть выигрыш - смотреть больше нечего; соперник грозит выиграть - только защиты
+    std::size_t keep = scored.size();
+    if (!scored.empty() && scored[0].first >= WINNING_MOVE) {
+        keep = 1;
+    } else if (!scored.empty() && scored[0].first >= FORCED_BLOCK) {
+        keep = 0;
+        while (keep < scored.size() && scored[keep].first >= FORCED_BLOCK) keep++;
+    } else if (ply > 0 && position.cellCount() > SMALL_BOARD) {
+        keep = std::min<std::size_t>(keep, MAX_BRANCH);
+    }
+    moves.clear();
+    for (std::size_t i = 0; i < keep; ++i) moves.push_back(scored[i].second);
+}
+
+int MnkEngine::negamax(Worker& worker, MnkPosition& position, int depth, int alpha, int beta, int ply) {
+    worker.nodes++;
+    // Победа проверяется только по окнам через последний ход - её отмечает play()
+    if (position.winner() != MnkPosition::EMPTY) return -(WIN - ply);
+    if (position.full()) return 0;
+    if (depth <= 0 || ply >= MAX_PLY - 1) return position.evaluate();
+    if ((worker.nodes & 1023) == 0 && timeUp()) return 0;
+
+    const int alphaStart = alpha;
+    Stored entry;
+    int ttMove = -1;
+    if (probe(position.hash(), entry)) {
+        ttMove = entry.move;
+        if (entry.depth >= depth) {
+            // Счёт до выигрыша хранится от текущей позиции, а не от корня
+            int stored = entry.score;
+            if (stored > WIN - MAX_PLY) stored -= ply;
+            else if (stored < -WIN + MAX_PLY) stored += ply;
+            // Окно не сужается: иначе выход за суженное окно записался бы как точная оценка
+            if (entry.bound == Exact ||
+                (entry.bound == Lower && stored >= beta) ||
+                (entry.bound == Upper && stored <= alpha))
+                return stored;
+        }
+    }
+
+    std::vector<int>& moves = worker.moveLists[ply];
+    position.candidates(moves);
+    orderMoves(worker, position, moves, ttMove, ply);
+
+    int best = -2 * WIN;
+    int bestMove = -1;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        int move = moves[i];
+        position.play(move);
+        int score;
+        if (i == 0) {
+            score = -negamax(worker, position, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            score = -negamax(worker, position, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta)
+                score = -negamax(worker, position, depth - 1, -beta, -alpha, ply + 1);
+        }
+        position.undo(move);
+        if (aborted) return 0;
+
+        if (score > best) {
+            best = score;
+            bestMove = move;
+        }
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) {
+            auto& killers = worker.killers[ply];
+            if (killers[0] != move) {
+                killers[1] = killers[0];
+                killers[0] = move;
+            }
+            worker.history[move] += depth * depth;
+            break;
+        }
+    }
+
+    int stored = best;
+    if (stored > WIN - MAX_PLY) stored += ply;
+    else if (stored < -WIN + MAX_PLY) stored -= ply;
+    store(position.hash(), stored, bestMove, depth,
+          best <= alphaStart ? Upper : (best >= beta ? Lower : Exact));
+    return best;
+}
+
+MnkEngine::Result MnkEngine::iterate(Worker& worker, const MnkPosition& root, int firstDepth, int depthStep, int maxDepth) {
+    Result result;
+    MnkPosition position = root;
+    std::vector<int> rootMoves;
+    position.candidates(rootMoves);
+    orderMoves(worker, position, rootMoves, -1, 0);
+    if (rootMoves.empty()) return result;
+    result.move = rootMoves[0];
+
+    const int emptyCells = position.cellCount() - position.moveCount();
+    for (int depth = firstDepth; depth <= std::min(maxDepth, MAX_PLY - 1); depth += depthStep) {
+        // Лучший ход прошлой итерации смотрится первым
+        auto previous = std::find(rootMoves.begin(), rootMoves.end(), result.move);
+        std::rotate(rootMoves.begin(), previous, previous + 1);
+
+        int alpha = -2 * WIN, beta = 2 * WIN;
+        int best = -2 * WIN;
+        int bestMove = rootMoves[0];
+        for (std::size_t i = 0; i < rootMoves.size(); ++i) {
+            int move = rootMoves[i];
+            position.play(move);
+            int score;
+            if (i == 0) {
+                score = -negamax(worker, position, depth - 1, -beta, -alpha, 1);
+            } else {
+                score = -negamax(worker, position, depth - 1, -alpha - 1, -alpha, 1);
+                if (score > alpha && !aborted)
+                    score = -negamax(worker, position, depth - 1, -beta, -alpha, 1);
+            }
+            position.undo(move);
+            if (aborted) break;
+            if (score > best) {
+                best = score;
+                bestMove = move;
+            }
+            alpha = std::max(alpha, score);
+        }
+        if (aborted) break;
+
+        result.move = bestMove;
+        result.score = best;
+        result.depth = depth;
+        // Исход известен точно или перебрано всё дерево
+        if (std::abs(best) > WIN - MAX_PLY || depth >= emptyCells) break;
+    }
+    return result;
+}
+
+MnkEngine::Result MnkEngine::search(const MnkPosition& root, std::chrono::milliseconds limit, int maxDepth) {
+    // Запрос stop() мог прийти раньше, чем поток дошёл до search(): он не сбрасывается,
+    // а переходит в флаг этого поиска. stop() ставит оба флага, поэтому не теряется и здесь
+    aborted = false;
+    if (stopRequested) aborted = true;
+    deadline = std::chrono::steady_clock::now() + limit;
+    for (Worker& worker : workers) {
+        worker.nodes = 0;
+        for (auto& value : worker.history) value /= 8;
+    }
+    if (root.winner() != MnkPosition::EMPTY || root.full()) return Result();
+
+    // Помощники ищут те же позиции со сдвигом по глубине: нечётные на ход впереди,
+    // вторая половина через глубину. Потоки расходятся по дереву и заранее
+    // заполняют таблицу для основного потока
+    std::vector<Result> results(workers.size());
+    std::vector<std::thread> helpers;
+    for (std::size_t i = 1; i < workers.size(); ++i) {
+        int firstDepth = 1 + static_cast<int>(i % 2);
+        int depthStep = 1 + static_cast<int>(i / 2 % 2);
+        helpers.emplace_back([this, &results, &root, i, firstDepth, depthStep, maxDepth] {
+            results[i] = iterate(workers[i], root, firstDepth, depthStep, maxDepth);
+        });
+    }
+    results[0] = iterate(workers[0], root, 1, 1, maxDepth);
+    aborted = true;
+    for (std::thread& helper : helpers) helper.join();
+
+    // Помощник мог успеть закончить итерацию глубже основного потока
+    Result result = results[0];
+    for (const Result& other : results)
+        if (other.move >= 0 && other.depth > result.depth) result = other;
+    result.nodes = 0;
+    for (const Worker& worker : workers) result.nodes += worker.nodes;
+    return result;
+}
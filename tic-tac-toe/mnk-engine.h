@@ -0,0 +1,141 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Доска m x n, побеждает k в ряд. Все отрезки длины k (окна) перечислены заранее;
+// ход обновляет только окна через свою клетку, поэтому и оценка, и проверка
+// победы смотрят лишь на линии через последний ход
+class MnkPosition {
+public:
+    static constexpr int MAX_SIZE = 19;
+    static constexpr int EMPTY = 0, X = 1, O = 2;
+
+    MnkPosition(int rows = 3, int cols = 3, int k = 3, int first = X);
+
+    int rows() const { return geometry->rows; }
+    int cols() const { return geometry->cols; }
+    int winLength() const { return geometry->k; }
+    int cellCount() const { return geometry->rows * geometry->cols; }
+
+    int at(int cell) const { return cells[cell]; }
+    int sideToMove() const { return side; }
+    int moveCount() const { return stones; }
+    bool full() const { return stones == cellCount(); }
+    // EMPTY, пока никто не собрал k в ряд
+    int winner() const { return completed[X] ? X : (completed[O] ? O : EMPTY); }
+    std::uint64_t hash() const { return key; }
+
+    void play(int cell);
+    void undo(int cell);
+
+    // Оценка для того, чей ход
+    int evaluate() const { return side == X ? score : -score; }
+    // Пустые клетки не дальше двух от камней; на пустой доске - центр
+    void candidates(std::vector<int>& moves) const;
+    // Польза хода для упорядочивания: свои и чужие окна, которые он продолжает
+    int moveValue(int cell) const;
+    // Вес окна, в котором count камней одного цвета; weight(k) - победа
+    int weight(int count) const { return geometry->weights[count]; }
+
+private:
+    struct Geometry {
+        int rows, cols, k;
+        std::vector<int> windowCells;      // по k клеток на окно
+        std::vector<int> cellWindowStart;  // окна клетки c: cellWindows[start[c]..start[c+1])
+        std::vector<int> cellWindows;
+        std::vector<int> weights;
+    };
+
+    std::shared_ptr<const Geometry> geometry;
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint8_t> near;  // камней в квадрате 5x5 вокруг клетки
+    std::vector<std::array<std::uint8_t, 2>> windowCounts;
+    std::array<int, 3> completed;
+    int side;
+    int stones;
+    int score;  // за X минус за O
+    std::uint64_t key;
+
+    static std::shared_ptr<const Geometry> makeGeometry(int rows, int cols, int k);
+    int windowScore(int window) const;
+};
+
+// Альфа-бета с итеративным углублением и таблицей транспозиций по ключам Зобриста.
+// Несколько потоков (Lazy SMP) ищут одну позицию независимо и делятся только таблицей
+class MnkEngine {
+public:
+    static constexpr int WIN = 1000000;
+    static constexpr int MAX_PLY = 128;
+    static constexpr int MAX_THREADS = 64;
+
+    struct Result {
+        int move = -1;
+        int score = 0;
+        int depth = 0;
+        std::uint64_t nodes = 0;  // сумма по всем потокам
+    };
+
+    explicit MnkEngine(int tableBits = 20, int threads = 1);
+
+    // Лучший ход за limit; прерванная итерация не учитывается
+    Result search(const MnkPosition& root, std::chrono::milliseconds limit, int maxDepth = MAX_PLY);
+    // Можно вызвать из другого потока, search() вернётся при ближайшей проверке.
+    // Запрос действует и на search(), который ещё не начался, и держится до resume()
+    void stop() {
+        stopRequested = true;
+        aborted = true;
+    }
+    // Вызывать до запуска потока с search(), а не внутри него: иначе stop(),
+    // пришедший раньше начала поиска, потеряется
+    void resume() { stopRequested = false; }
+    void clear();
+    // Не вызывать во время search()
+    void setThreads(int count);
+    int threads() const { return static_cast<int>(workers.size()); }
+
+private:
+    enum Bound : std::uint8_t { Exact, Lower, Upper };
+
+    // Запись - два атомарных слова без блокировок: data и key ^ data.
+    // Если два потока пишут одну запись одновременно, читатель получит
+    // половинки от разных записей, ключ не сойдётся и это будет просто промах
+    struct Entry {
+        std::atomic<std::uint64_t> check{0};
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    struct Stored {
+        int score;
+        int move;
+        int depth;
+        int bound;
+    };
+
+    // Всё, что поток меняет во время поиска, кроме таблицы
+    struct Worker {
+        std::vector<int> history;
+        std::array<std::array<int, 2>, MAX_PLY> killers;
+        std::vector<std::vector<int>> moveLists;  // по списку на ply, чтобы не выделять память в поиске
+        std::vector<std::vector<std::pair<int, int>>> scoredLists;  // (польза, ход) для orderMoves, так же по ply
+        std::uint64_t nodes = 0;
+    };
+
+    std::vector<Entry> table;
+    std::vector<Worker> workers;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> aborted;  // этот поиск прерван: stop(), время вышло или основной поток закончил
+    std::chrono::steady_clock::time_point deadline;
+
+    bool probe(std::uint64_t key, Stored& stored) const;
+    void store(std::uint64_t key, int score, int move, int depth, Bound bound);
+
+    Result iterate(Worker& worker, const MnkPosition& root, int firstDepth, int depthStep, int maxDepth);
+    int negamax(Worker& worker, MnkPosition& position, int depth, int alpha, int beta, int ply);
+    void orderMoves(Worker& worker, const MnkPosition& position, std::vector<int>& moves, int ttMove, int ply);
+    bool timeUp();
+};
@@ -0,0 +1,412 @@
+#include "qubic-engine.h"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define QUBIC_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Lines = std::array<std::uint64_t, QubicPosition::LINE_COUNT>;
+
+// 13 направлений с первой ненулевой составляющей +1; линия начинается там, где
+// по каждой ненулевой оси дальше назад клеток нет
+constexpr Lines makeLines() {
+    Lines lines{};
+    int count = 0;
+    for (int dl = -1; dl <= 1; ++dl)
+        for (int dr = -1; dr <= 1; ++dr)
+            for (int dc = -1; dc <= 1; ++dc) {
+                int first = dl != 0 ? dl : (dr != 0 ? dr : dc);
+                if (first != 1) continue;
+                for (int cell = 0; cell < QubicPosition::CELLS; ++cell) {
+                    int layer = cell / 16, row = cell / 4 % 4, col = cell % 4;
+                    if ((dl == 1 && layer != 0) || (dl == -1 && layer != 3) ||
+                        (dr == 1 && row != 0) || (dr == -1 && row != 3) ||
+                        (dc == 1 && col != 0) || (dc == -1 && col != 3)) continue;
+                    std::uint64_t line = 0;
+                    for (int step = 0; step < 4; ++step)
+                        line |= std::uint64_t(1) << ((layer + dl * step) * 16 + (row + dr * step) * 4 + col + dc * step);
+                    lines[count++] = line;
+                }
+            }
+    return lines;
+}
+
+alignas(32) constexpr Lines LINES = makeLines();
+
+constexpr int lineCount(int cell) {
+    int count = 0;
+    for (std::uint64_t line : LINES)
+        count += (line >> cell & 1) ? 1 : 0;
+    return count;
+}
+
+constexpr std::array<int, QubicPosition::CELLS> makeCellLines() {
+    std::array<int, QubicPosition::CELLS> result{};
+    for (int cell = 0; cell < QubicPosition::CELLS; ++cell)
+        result[cell] = lineCount(cell);
+    return result;
+}
+
+// Углы и центральный куб 2x2x2 лежат на семи линиях, остальные клетки - на четырёх
+constexpr std::array<int, QubicPosition::CELLS> CELL_LINES = makeCellLines();
+
+static_assert(LINES[QubicPosition::LINE_COUNT - 1] != 0, "линий должно быть ровно 76");
+static_assert(CELL_LINES[0] == 7 && CELL_LINES[1] == 4 && CELL_LINES[21] == 7, "углы и центр на семи линиях");
+
+// Вес живой линии (без камней соперника) по числу своих камней. Собранная четвёрка
+// веса не даёт: партия уже окончена, её ловит lost, а маски с ней бывают в проверках ядер
+constexpr int LINE_WEIGHTS[5] = {0, 1, 10, 100, 0};
+
+// Порядок ходов: ход из таблицы, тройки свои и чужие, убийцы, история
+constexpr int TT_MOVE = 1 << 20;
+constexpr int ATTACK = 1 << 16;
+constexpr int DEFENCE = 1 << 15;
+constexpr int KILLER = 1 << 14;
+constexpr int HISTORY_LIMIT = (1 << 14) - 1;
+
+}
+
+QubicPosition::QubicPosition(int first)
+    : marks{},
+      side(first),
+      stones(0) {
+}
+
+int QubicPosition::at(int cell) const {
+    if (marks[0] >> cell & 1) return X;
+    if (marks[1] >> cell & 1) return O;
+    return EMPTY;
+}
+
+int QubicPosition::winner() const {
+    for (std::uint64_t line : LINES) {
+        if ((marks[0] & line) == line) return X;
+        if ((marks[1] & line) == line) return O;
+    }
+    return EMPTY;
+}
+
+std::uint64_t QubicPosition::hash() const {
+    // Умножение на нечётное - биекция; перемешивание splitmix64
+    std::uint64_t h = marks[0] * 0x9E3779B97F4A7C15ULL;
+    h ^= (marks[1] * 0xC2B2AE3D27D4EB4FULL) + static_cast<std::uint64_t>(side);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+void QubicPosition::play(int cell) {
+    marks[side - 1] |= std::uint64_t(1) << cell;
+    stones++;
+    side = X + O - side;
+}
+
+void QubicPosition::undo(int cell) {
+    side = X + O - side;
+    stones--;
+    marks[side - 1] &= ~(std::uint64_t(1) << cell);
+}
+
+const std::array<std::uint64_t, QubicPosition::LINE_COUNT>& QubicPosition::lines() {
+    return LINES;
+}
+
+QubicEngine::QubicEngine(int tableBits)
+    : table(std::size_t(1) << tableBits),
+      stopRequested(false),
+      aborted(false),
+      nodes(0),
+      activeKernel(bestKernel()) {
+    clear();
+}
+
+QubicEngine::Kernel QubicEngine::bestKernel() {
+#ifdef QUBIC_SIMD
+    if (__builtin_cpu_supports("avx2")) return Avx2;
+#endif
+    return Scalar;
+}
+
+void QubicEngine::setKernel(Kernel requested) {
+    Kernel best = bestKernel();
+    activeKernel = requested > best ? best : requested;
+}
+
+void QubicEngine::clear() {
+    std::fill(table.begin(), table.end(), Entry());
+    history.fill(0);
+    for (auto& slot : killers) slot = {-1, -1};
+}
+
+QubicEngine::Evaluation QubicEngine::evaluateScalar(std::uint64_t mine, std::uint64_t theirs) {
+    Evaluation result;
+    for (std::uint64_t line : LINES) {
+        int own = __builtin_popcountll(mine & line);
+        int opp = __builtin_popcountll(theirs & line);
+        if (opp == 0) {
+            result.score += LINE_WEIGHTS[own];
+            if (own == 3) result.wins |= line & ~mine;
+            if (own == 2) result.attacks |= line & ~mine;
+        }
+        if (own == 0) {
+            if (opp == 4) result.lost = true;
+            else result.score -= LINE_WEIGHTS[opp];
+            if (opp == 3) result.threats |= line & ~theirs;
+            if (opp == 2) result.defences |= line & ~theirs;
+        }
+    }
+    return result;
+}
+
+#ifdef QUBIC_SIMD
+
+#define AVX2_INLINE inline __attribute__((target("avx2"), always_inline))
+
+// Камней в каждой из четырёх 64-битных масок: popcount полубайтов через таблицу
+// vpshufb и сумма байтов через vpsadbw
+AVX2_INLINE __m256i popcount64(__m256i value) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(value, low)),
+                                     _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(value, 4), low)));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+AVX2_INLINE std::uint64_t orLanes(__m256i value) {
+    __m128i half = _mm_or_si128(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+    return static_cast<std::uint64_t>(_mm_cvtsi128_si64(half) | _mm_extract_epi64(half, 1));
+}
+
+AVX2_INLINE std::int64_t sumLanes(__m256i value) {
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+    return _mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1);
+}
+
+// Тот же проход, что в evaluateScalar, по четыре линии за раз без ветвлений.
+// Число камней в линии не больше 4, поэтому вес берётся из таблицы в байтах через vpshufb
+__attribute__((target("avx2"))) QubicEngine::Evaluation QubicEngine::evaluateAvx2(std::uint64_t mine, std::uint64_t theirs) {
+    const __m256i weights = _mm256_setr_epi8(LINE_WEIGHTS[0], LINE_WEIGHTS[1], LINE_WEIGHTS[2], LINE_WEIGHTS[3],
+                                             LINE_WEIGHTS[4], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                             LINE_WEIGHTS[0], LINE_WEIGHTS[1], LINE_WEIGHTS[2], LINE_WEIGHTS[3],
+                                             LINE_WEIGHTS[4], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i two = _mm256_set1_epi64x(2), three = _mm256_set1_epi64x(3), four = _mm256_set1_epi64x(4);
+    const __m256i myMask = _mm256_set1_epi64x(static_cast<long long>(mine));
+    const __m256i theirMask = _mm256_set1_epi64x(static_cast<long long>(theirs));
+
+    __m256i myScore = zero, theirScore = zero, lost = zero;
+    __m256i wins = zero, threats = zero, attacks = zero, defences = zero;
+    for (int i = 0; i < QubicPosition::LINE_COUNT; i += 4) {
+        __m256i line = _mm256_load_si256(reinterpret_cast<const __m256i*>(&LINES[i]));
+        __m256i own = popcount64(_mm256_and_si256(line, myMask));
+        __m256i opp = popcount64(_mm256_and_si256(line, theirMask));
+        // Камни в линии только одного цвета, иначе 0
+        __m256i myLive = _mm256_and_si256(own, _mm256_cmpeq_epi64(opp, zero));
+        __m256i theirLive = _mm256_and_si256(opp, _mm256_cmpeq_epi64(own, zero));
+        __m256i myEmpty = _mm256_andnot_si256(myMask, line);
+        __m256i theirEmpty = _mm256_andnot_si256(theirMask, line);
+
+        myScore = _mm256_add_epi64(myScore, _mm256_shuffle_epi8(weights, myLive));
+        // Четвёрка, своя или соперника, получает вес LINE_WEIGHTS[4], как в скалярном ядре
+        theirScore = _mm256_add_epi64(theirScore, _mm256_shuffle_epi8(weights, theirLive));
+        lost = _mm256_or_si256(lost, _mm256_cmpeq_epi64(opp, four));
+        wins = _mm256_or_si256(wins, _mm256_and_si256(_mm256_cmpeq_epi64(myLive, three), myEmpty));
+        attacks = _mm256_or_si256(attacks, _mm256_and_si256(_mm256_cmpeq_epi64(myLive, two), myEmpty));
+        threats = _mm256_or_si256(threats, _mm256_and_si256(_mm256_cmpeq_epi64(theirLive, three), theirEmpty));
+        defences = _mm256_or_si256(defences, _mm256_and_si256(_mm256_cmpeq_epi64(theirLive, two), theirEmpty));
+    }
+
+    Evaluation result;
+    result.score = static_cast<int>(sumLanes(myScore) - sumLanes(theirScore));
+    result.lost = !_mm256_testz_si256(lost, lost);
+    result.wins = orLanes(wins);
+    result.threats = orLanes(threats);
+    result.attacks = orLanes(attacks);
+    result.defences = orLanes(defences);
+    return result;
+}
+
+#else
+
+// Без x86 векторное ядро недоступно, bestKernel() его не выбирает
+QubicEngine::Evaluation QubicEngine::evaluateAvx2(std::uint64_t mine, std::uint64_t theirs) {
+    return evaluateScalar(mine, theirs);
+}
+
+#endif
+
+bool QubicEngine::timeUp() {
+    if (std::chrono::steady_clock::now() >= deadline) aborted = true;
+    return aborted;
+}
+
+int QubicEngine::orderMoves(const QubicPosition& position, const Evaluation& evaluation, int ttMove, int ply, int* moves) const {
+    // Выигрыш - смотреть больше нечего; одна угроза соперника - единственная защита
+    if (evaluation.wins) {
+        moves[0] = __builtin_ctzll(evaluation.wins);
+        return 1;
+    }
+    if (evaluation.threats) {
+        moves[0] = __builtin_ctzll(evaluation.threats);
+        return 1;
+    }
+
+    std::pair<int, int> scored[QubicPosition::CELLS];
+    int count = 0;
+    for (std::uint64_t empty = position.empty(); empty; empty &= empty - 1) {
+        int cell = __builtin_ctzll(empty);
+        std::uint64_t bit = std::uint64_t(1) << cell;
+        int value = std::min(history[cell], HISTORY_LIMIT - 7) + CELL_LINES[cell];
+        if (evaluation.attacks & bit) value += ATTACK;
+        if (evaluation.defences & bit) value += DEFENCE;
+        if (cell == killers[ply][0] || cell == killers[ply][1]) value += KILLER;
+        if (cell == ttMove) value = TT_MOVE;
+        scored[count++] = {value, cell};
+    }
+    std::sort(scored, scored + count, [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (int i = 0; i < count; ++i) moves[i] = scored[i].second;
+    return count;
+}
+
+int QubicEngine::negamax(QubicPosition& position, int depth, int alpha, int beta, int ply) {
+    nodes++;
+    int side = position.sideToMove();
+    Evaluation evaluation = evaluate(position.mask(side), position.mask(QubicPosition::X + QubicPosition::O - side));
+    if (evaluation.lost) return -(WIN - ply);
+    if (position.full()) return 0;
+    if (evaluation.wins) return WIN - ply - 1;
+    // Две клетки, где соперник собирает линию, одним ходом не закрыть
+    if (evaluation.threats & (evaluation.threats - 1)) return -(WIN - ply - 2);
+    // Вынужденная защита не тратит глубину, чтобы тройки не прятались за горизонтом
+    if ((depth <= 0 && !evaluation.threats) || ply >= MAX_PLY - 1) return evaluation.score;
+    if ((nodes & 1023) == 0 && timeUp()) return 0;
+
+    const int alphaStart = alpha;
+    Entry& entry = table[position.hash() & (table.size() - 1)];
+    int ttMove = -1;
+    if (entry.key == position.hash()) {
+        ttMove = entry.move;
+        if (entry.depth >= depth) {
+            // Счёт до выигрыша хранится от текущей позиции, а не от корня
+            int stored = entry.score;
+            if (stored > WIN - MAX_PLY) stored -= ply;
+            else if (stored < -WIN + MAX_PLY) stored += ply;
+            if (entry.bound == Exact ||
+                (entry.bound == Lower && stored >= beta) ||
+                (entry.bound == Upper && stored <= alpha))
+                return stored;
+        }
+    }
+
+    int moves[QubicPosition::CELLS];
+    int count = orderMoves(position, evaluation, ttMove, ply, moves);
+    int nextDepth = evaluation.threats ? depth : depth - 1;
+
+    int best = -2 * WIN;
+    int bestMove = -1;
+    for (int i = 0; i < count; ++i) {
+        int move = moves[i];
+        position.play(move);
+        int score;
+        if (i == 0) {
+            score = -negamax(position, nextDepth, -beta, -alpha, ply + 1);
+        } else {
+            score = -negamax(position, nextDepth, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta)
+                score = -negamax(position, nextDepth, -beta, -alpha, ply + 1);
+        }
+        position.undo(move);
+        if (aborted) return 0;
+
+        if (score > best) {
+            best = score;
+            bestMove = move;
+        }
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) {
+            if (killers[ply][0] != move) {
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = move;
+            }
+            history[move] += depth * depth;
+            break;
+        }
+    }
+
+    int stored = best;
+    if (stored > WIN - MAX_PLY) stored += ply;
+    else if (stored < -WIN + MAX_PLY) stored -= ply;
+    entry.key = position.hash();
+    entry.score = stored;
+    entry.move = static_cast<std::int8_t>(bestMove);
+    entry.depth = static_cast<std::int8_t>(depth);
+    entry.bound = best <= alphaStart ? Upper : (best >= beta ? Lower : Exact);
+    return best;
+}
+
+QubicEngine::Result QubicEngine::search(const QubicPosition& root, std::chrono::milliseconds limit, int maxDepth) {
+    // Запрос stop() мог прийти раньше, чем поток дошёл до search(): он не сбрасывается,
+    // а переходит в флаг этого поиска. stop() ставит оба флага, поэтому не теряется и здесь
+    aborted = false;
+    if (stopRequested) aborted = true;
+    deadline = std::chrono::steady_clock::now() + limit;
+    nodes = 0;
+    for (int& value : history) value /= 8;
+
+    Result result;
+    QubicPosition position = root;
+    if (position.winner() != QubicPosition::EMPTY || position.full()) return result;
+
+    int side = position.sideToMove();
+    Evaluation evaluation = evaluate(position.mask(side), position.mask(QubicPosition::X + QubicPosition::O - side));
+    int rootMoves[QubicPosition::CELLS];
+    int count = orderMoves(position, evaluation, -1, 0, rootMoves);
+    result.move = rootMoves[0];
+    // Единственный разумный ход искать незачем
+    if (count == 1) return result;
+
+    const int emptyCells = QubicPosition::CELLS - position.moveCount();
+    for (int depth = 1; depth <= std::min(maxDepth, MAX_PLY - 1); ++depth) {
+        // Лучший ход прошлой итерации смотрится первым
+        auto previous = std::find(rootMoves, rootMoves + count, result.move);
+        std::rotate(rootMoves, previous, previous + 1);
+
+        int alpha = -2 * WIN, beta = 2 * WIN;
+        int best = -2 * WIN;
+        int bestMove = rootMoves[0];
+        for (int i = 0; i < count; ++i) {
+            int move = rootMoves[i];
+            position.play(move);
+            int score;
+            if (i == 0) {
+                score = -negamax(position, depth - 1, -beta, -alpha, 1);
+            } else {
+                score = -negamax(position, depth - 1, -alpha - 1, -alpha, 1);
+                if (score > alpha && !aborted)
+                    score = -negamax(position, depth - 1, -beta, -alpha, 1);
+            }
+            position.undo(move);
+            if (aborted) break;
+            if (score > best) {
+                best = score;
+                bestMove = move;
+            }
+            alpha = std::max(alpha, score);
+        }
+        if (aborted) break;
+
+        result.move = bestMove;
+        result.score = best;
+        result.depth = depth;
+        // Исход известен точно или перебрано всё дерево
+        if (std::abs(best) > WIN - MAX_PLY || depth >= emptyCells) break;
+    }
+    result.nodes = nodes;
+    return result;
+}
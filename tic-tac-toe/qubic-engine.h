@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Qubic: куб 4x4x4, побеждают четыре в ряд по любой из 76 линий.
+// Клетка cell = layer * 16 + row * 4 + col; позиция - по 64-битной маске на игрока
+class QubicPosition {
+public:
+    static constexpr int CELLS = 64;
+    static constexpr int LINE_COUNT = 76;
+    static constexpr int EMPTY = 0, X = 1, O = 2;
+
+    explicit QubicPosition(int first = X);
+
+    int at(int cell) const;
+    int sideToMove() const { return side; }
+    int moveCount() const { return stones; }
+    bool full() const { return stones == CELLS; }
+    std::uint64_t mask(int player) const { return marks[player - 1]; }
+    std::uint64_t empty() const { return ~(marks[0] | marks[1]); }
+    // X или O, если у него есть четыре в ряд; просматривает все линии
+    int winner() const;
+    std::uint64_t hash() const;
+
+    void play(int cell);
+    void undo(int cell);
+
+    // Линии как маски клеток, по четыре подряд для загрузки в один регистр AVX2
+    static const std::array<std::uint64_t, LINE_COUNT>& lines();
+
+private:
+    std::array<std::uint64_t, 2> marks;
+    int side;
+    int stones;
+};
+
+// Альфа-бета с итеративным углублением. Каждый узел один раз проходит все 76 линий
+// (на AVX2 по четыре за раз): из этого прохода берутся и оценка, и конец партии,
+// и вынужденные ходы
+class QubicEngine {
+public:
+    static constexpr int WIN = 1000000;
+    static constexpr int MAX_PLY = 64;
+
+    enum Kernel { Scalar, Avx2 };
+
+    struct Result {
+        int move = -1;
+        int score = 0;
+        int depth = 0;
+        std::uint64_t nodes = 0;
+    };
+
+    // Всё для того, чей ход (mine); клетки - пустые клетки линий
+    struct Evaluation {
+        int score = 0;               // веса живых линий: свои минус чужие
+        bool lost = false;           // у соперника четыре в ряд
+        std::uint64_t wins = 0;      // ход сюда собирает свою линию
+        std::uint64_t threats = 0;   // ход сюда собрал бы линию сопернику
+        std::uint64_t attacks = 0;   // ход сюда даёт свою тройку в живой линии
+        std::uint64_t defences = 0;  // ход сюда ломает тройку соперника
+    };
+
+    explicit QubicEngine(int tableBits = 20);
+
+    static Kernel bestKernel();
+    // Недоступное процессору ядро заменяется лучшим доступным
+    void setKernel(Kernel requested);
+    Kernel kernel() const { return activeKernel; }
+
+    Evaluation evaluate(std::uint64_t mine, std::uint64_t theirs) const {
+        return activeKernel == Avx2 ? evaluateAvx2(mine, theirs) : evaluateScalar(mine, theirs);
+    }
+    static Evaluation evaluateScalar(std::uint64_t mine, std::uint64_t theirs);
+    static Evaluation evaluateAvx2(std::uint64_t mine, std::uint64_t theirs);
+
+    // Лучший ход за limit; прерванная итерация не учитывается
+    Result search(const QubicPosition& root, std::chrono::milliseconds limit, int maxDepth = MAX_PLY);
+    // Можно вызвать из другого потока, search() вернётся при ближайшей проверке.
+    // Запрос действует и на search(), который ещё не начался, и держится до resume()
+    void stop() {
+        stopRequested = true;
+        aborted = true;
+    }
+    // Вызывать до запуска потока с search(), а не внутри него: иначе stop(),
+    // пришедший раньше начала поиска, потеряется
+    void resume() { stopRequested = false; }
+    void clear();
+
+private:
+    enum Bound : std::uint8_t { Exact, Lower, Upper };
+
+    struct Entry {
+        std::uint64_t key = 0;
+        std::int32_t score = 0;
+        std::int8_t move = -1;
+        std::int8_t depth = -1;
+        std::uint8_t bound = Exact;
+    };
+
+    std::vector<Entry> table;
+    std::array<int, QubicPosition::CELLS> history;
+    std::array<std::array<int, 2>, MAX_PLY> killers;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> aborted;  // этот поиск прерван: stop() или время вышло
+    std::chrono::steady_clock::time_point deadline;
+    std::uint64_t nodes;
+    Kernel activeKernel;
+
+    int negamax(QubicPosition& position, int depth, int alpha, int beta, int ply);
+    // Ходы по убыванию пользы; возвращает их число
+    int orderMoves(const QubicPosition& position, const Evaluation& evaluation, int ttMove, int ply, int* moves) const;
+    bool timeUp();
+};
@@ -0,0 +1,274 @@
+// Поиск без окон: perft для проверки генерации ходов и замер поисков на эталонных
+// позициях 3x3, 4x4 и m,n,k - полный перебор minimax, альфа-бета MnkEngine в один
+// и в несколько потоков, для Ultimate - perft и партии MCTS в секунду, для Qubic -
+// поиск со скалярной и AVX2 оценкой
+// tictactoe_bench [--threads N] [--quick]
+// При расхождении perft, числа узлов minimax с эталоном или ядер Qubic между собой
+// код возврата 1
+
+#include "mnk-engine.h"
+#include "qubic-engine.h"
+#include "tic-tac-toe-table.h"
+#include "ultimate-engine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Reference {
+    const char *name;
+    int rows, cols, k;
+    std::vector<std::pair<int, int>> moves;  // (строка, столбец) по очереди с X
+    int depth;
+    std::uint64_t expected;  // 0 - эталона нет
+    bool slow;               // пропускается с --quick
+};
+
+// Число позиций ровно на глубине depth; выигранные раньше партии не продолжаются
+const std::vector<Reference> PERFT = {
+    {"3x3 empty", 3, 3, 3, {}, 9, 46080, false},
+    {"3x3 center", 3, 3, 3, {{1,1}}, 8, 4608, false},
+    {"4x4 empty", 4, 4, 4, {}, 5, 524160, false},
+    {"7x7 k=4", 7, 7, 4, {{3,3}, {3,4}}, 4, 4280760, false},
+    {"15x15 opening", 15, 15, 5, {{7,7}, {7,8}, {8,8}}, 3, 10793640, true},
+};
+
+// expected - узлы полного перебора minimax, включая корень
+const std::vector<Reference> SEARCH = {
+    {"3x3 empty", 3, 3, 3, {}, 9, 549946, false},
+    {"3x3 corner", 3, 3, 3, {{0,0}}, 8, 59705, false},
+    {"4x4 empty", 4, 4, 4, {}, 5, 571457, false},
+    {"4x4 middlegame", 4, 4, 4, {{1,1}, {2,2}, {1,2}, {2,1}}, 7, 4371885, true},
+    {"7x7 k=4", 7, 7, 4, {{3,3}, {3,4}}, 4, 4380260, false},
+    {"15x15 opening", 15, 15, 5, {{7,7}, {7,8}, {8,8}}, 3, 10842925, true},
+};
+
+const std::uint64_t ULTIMATE_PERFT[] = {1, 81, 720, 6336, 55080, 473256, 4020960};
+
+const int QUBIC_OPENING[] = {0, 21, 42, 1, 22};
+const int QUBIC_DEPTH = 6;
+
+double elapsedSeconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+MnkPosition setUp(const Reference& reference) {
+    MnkPosition position(reference.rows, reference.cols, reference.k);
+    for (auto move : reference.moves)
+        position.play(move.first * reference.cols + move.second);
+    return position;
+}
+
+std::uint64_t perft(MnkPosition& position, int depth) {
+    if (position.winner() != MnkPosition::EMPTY) return 0;
+    if (depth == 0) return 1;
+    std::uint64_t count = 0;
+    for (int cell = 0; cell < position.cellCount(); ++cell) {
+        if (position.at(cell) != MnkPosition::EMPTY) continue;
+        position.play(cell);
+        count += perft(position, depth - 1);
+        position.undo(cell);
+    }
+    return count;
+}
+
+std::uint64_t perft(const UltimatePosition& position, int depth) {
+    if (position.winner() != UltimatePosition::EMPTY) return 0;
+    if (depth == 0) return 1;
+    int moves[UltimatePosition::CELLS];
+    int count = position.legalMoves(moves);
+    if (depth == 1) return count;
+    std::uint64_t total = 0;
+    for (int i = 0; i < count; ++i) {
+        UltimatePosition next = position;
+        next.play(moves[i]);
+        total += perft(next, depth - 1);
+    }
+    return total;
+}
+
+// Полный перебор без отсечений и таблиц, как прежний MainWindow::minimax,
+// но с оценками MnkEngine, чтобы счёт сравнивался с альфа-бетой
+int minimax(MnkPosition& position, int depth, int ply, std::uint64_t& nodes, int *bestMove = nullptr) {
+    nodes++;
+    if (position.winner() != MnkPosition::EMPTY) return -(MnkEngine::WIN - ply);
+    if (position.full()) return 0;
+    if (depth == 0) return position.evaluate();
+    int best = -2 * MnkEngine::WIN;
+    for (int cell = 0; cell < position.cellCount(); ++cell) {
+        if (position.at(cell) != MnkPosition::EMPTY) continue;
+        position.play(cell);
+        int score = -minimax(position, depth - 1, ply + 1, nodes);
+        position.undo(cell);
+        if (score > best) {
+            best = score;
+            if (bestMove) *bestMove = cell;
+        }
+    }
+    return best;
+}
+
+// Случайные позиции Qubic, на которых ядро kernel оценивает не так, как скалярное
+int qubicKernelMismatches(QubicEngine::Kernel kernel) {
+    QubicEngine engine(10);
+    engine.setKernel(kernel);
+    std::mt19937_64 rng(1);
+    int mismatches = 0;
+    for (int sample = 0; sample < 100000; ++sample) {
+        std::uint64_t stones[2] = {0, 0};
+        int count = static_cast<int>(rng() % QubicPosition::CELLS);
+        for (int i = 0; i < count; ++i)
+            stones[i & 1] |= (std::uint64_t(1) << (rng() % QubicPosition::CELLS)) & ~(stones[0] | stones[1]);
+        QubicEngine::Evaluation expected = QubicEngine::evaluateScalar(stones[0], stones[1]);
+        QubicEngine::Evaluation actual = engine.evaluate(stones[0], stones[1]);
+        if (expected.score != actual.score || expected.lost != actual.lost ||
+            expected.wins != actual.wins || expected.threats != actual.threats ||
+            expected.attacks != actual.attacks || expected.defences != actual.defences)
+            mismatches++;
+    }
+    return mismatches;
+}
+
+void printRow(const char *engine, int score, int move, std::uint64_t nodes, double seconds, const char *check) {
+    std::printf("  %-14s %9d %5d %12llu %10.1f %12.0f  %s\n", engine, score, move,
+                static_cast<unsigned long long>(nodes), seconds * 1000, seconds > 0 ? nodes / seconds : 0.0, check);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    bool quick = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--threads") && hasValue) {
+            threads = std::max(1, std::min(MnkEngine::MAX_THREADS, std::atoi(argv[++i])));
+        } else if (!std::strcmp(argv[i], "--quick")) {
+            quick = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--threads N] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int mismatches = 0;
+    auto verdict = [&mismatches](std::uint64_t nodes, std::uint64_t expected) {
+        if (expected == 0) return "";
+        if (nodes == expected) return "ok";
+        mismatches++;
+        return "MISMATCH";
+    };
+
+    std::printf("perft\n");
+    std::printf("  %-18s %5s %12s %12s %10s %12s\n", "position", "depth", "nodes", "expected", "ms", "nodes/s");
+    for (const Reference& reference : PERFT) {
+        if (quick && reference.slow) continue;
+        MnkPosition position = setUp(reference);
+        auto start = Clock::now();
+        std::uint64_t nodes = perft(position, reference.depth);
+        double seconds = elapsedSeconds(start);
+        std::printf("  %-18s %5d %12llu %12llu %10.1f %12.0f  %s\n", reference.name, reference.depth,
+                    static_cast<unsigned long long>(nodes), static_cast<unsigned long long>(reference.expected),
+                    seconds * 1000, nodes / std::max(seconds, 1e-9), verdict(nodes, reference.expected));
+    }
+    int ultimateDepth = quick ? 5 : 6;
+    {
+        auto start = Clock::now();
+        std::uint64_t nodes = perft(UltimatePosition(), ultimateDepth);
+        double seconds = elapsedSeconds(start);
+        std::printf("  %-18s %5d %12llu %12llu %10.1f %12.0f  %s\n", "ultimate empty", ultimateDepth,
+                    static_cast<unsigned long long>(nodes),
+                    static_cast<unsigned long long>(ULTIMATE_PERFT[ultimateDepth]),
+                    seconds * 1000, nodes / std::max(seconds, 1e-9), verdict(nodes, ULTIMATE_PERFT[ultimateDepth]));
+    }
+
+    // Счёт - для того, чей ход; выигрыш - около MnkEngine::WIN
+    std::printf("\nsearch, %d threads for the parallel engine\n", threads);
+    std::printf("  %-14s %9s %5s %12s %10s %12s\n", "engine", "score", "move", "nodes", "ms", "nodes/s");
+    for (const Reference& reference : SEARCH) {
+        if (quick && reference.slow) continue;
+        std::printf("%s, depth %d\n", reference.name, reference.depth);
+        MnkPosition position = setUp(reference);
+
+        std::uint64_t nodes = 0;
+        int move = -1;
+        auto start = Clock::now();
+        int score = minimax(position, reference.depth, 0, nodes, &move);
+        printRow("minimax", score, move, nodes, elapsedSeconds(start), verdict(nodes, reference.expected));
+
+        for (int count : {1, threads}) {
+            // Каждый замер с пустой таблицей, иначе следующий получит готовые оценки
+            MnkEngine engine(20, count);
+            start = Clock::now();
+            MnkEngine::Result result = engine.search(position, std::chrono::hours(1), reference.depth);
+            char name[32];
+            std::snprintf(name, sizeof(name), "alphabeta x%d", count);
+            printRow(name, result.score, result.move, result.nodes, elapsedSeconds(start), "");
+            if (threads == 1) break;
+        }
+
+        if (reference.rows == 3 && reference.cols == 3 && reference.k == 3) {
+            int key = 0;
+            for (int cell = 0; cell < PerfectPlay::CELLS; ++cell)
+                key += PerfectPlay::POW3[cell] * position.at(cell);
+            int side = position.sideToMove() == MnkPosition::X ? PerfectPlay::X : PerfectPlay::O;
+            const PerfectPlay::Entry& entry = PerfectPlay::lookup(key, side);
+            int best = 0;
+            while (best < PerfectPlay::CELLS && !(entry.bestMoves >> best & 1)) best++;
+            printRow("table", entry.score, best, 1, 0, "");
+        }
+    }
+
+    std::printf("\nultimate MCTS, 500 ms from the empty board\n");
+    std::printf("  %-14s %9s %5s %12s %10s %12s\n", "engine", "win %", "move", "playouts", "ms", "playouts/s");
+    for (int count : {1, threads}) {
+        UltimateEngine engine(count);
+        auto start = Clock::now();
+        UltimateEngine::Result result = engine.search(UltimatePosition(), std::chrono::milliseconds(500));
+        char name[32];
+        std::snprintf(name, sizeof(name), "mcts x%d", count);
+        printRow(name, static_cast<int>(result.winRate * 100), result.move, result.playouts, elapsedSeconds(start), "");
+        if (threads == 1) break;
+    }
+
+    // Оценки ядер совпадают, поэтому и деревья поиска должны совпасть узел в узел
+    std::printf("\nqubic, depth %d after %d opening moves\n", QUBIC_DEPTH, static_cast<int>(std::size(QUBIC_OPENING)));
+    std::printf("  %-14s %9s %5s %12s %10s %12s\n", "kernel", "score", "move", "nodes", "ms", "nodes/s");
+    QubicPosition qubic;
+    for (int cell : QUBIC_OPENING)
+        qubic.play(cell);
+    const char* kernelNames[] = {"scalar", "avx2"};
+    std::uint64_t scalarNodes = 0;
+    for (int kernel = QubicEngine::Scalar; kernel <= QubicEngine::bestKernel(); ++kernel) {
+        int differences = qubicKernelMismatches(static_cast<QubicEngine::Kernel>(kernel));
+        if (differences > 0) {
+            std::fprintf(stderr, "%s: %d qubic evaluations differ from the scalar kernel\n",
+                         kernelNames[kernel], differences);
+            mismatches++;
+        }
+        QubicEngine engine;
+        engine.setKernel(static_cast<QubicEngine::Kernel>(kernel));
+        auto start = Clock::now();
+        QubicEngine::Result result = engine.search(qubic, std::chrono::hours(1), QUBIC_DEPTH);
+        if (kernel == QubicEngine::Scalar) scalarNodes = result.nodes;
+        printRow(kernelNames[kernel], result.score, result.move, result.nodes, elapsedSeconds(start),
+                 kernel == QubicEngine::Scalar ? "" : verdict(result.nodes, scalarNodes));
+    }
+
+    if (mismatches > 0) {
+        std::fprintf(stderr, "%d checks differ from the reference\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
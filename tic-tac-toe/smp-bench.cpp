@@ -0,0 +1,80 @@
+// Масштабирование MnkEngine по потокам: время до заданной глубины и узлы в секунду
+// на фиксированных позициях при 1, 2, 4 и 8 потоках
+// tictactoe_smp [--depth D] [--table BITS]
+// --depth прибавляется к глубине каждой позиции
+
+#include "mnk-engine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchPosition {
+    const char *name;
+    int rows, cols, k;
+    int depth;
+    std::vector<std::pair<int, int>> moves;  // (строка, столбец) по очереди с X
+};
+
+const std::vector<BenchPosition> POSITIONS = {
+    {"4x4 empty", 4, 4, 4, 11, {}},
+    {"15x15 opening", 15, 15, 5, 9, {{7,7}, {7,8}, {8,8}, {6,6}, {8,7}}},
+    {"15x15 middlegame", 15, 15, 5, 9,
+        {{7,7}, {6,6}, {7,6}, {7,8}, {8,7}, {6,7}, {8,8}, {9,9}, {6,5}, {5,4}}},
+    {"19x19 opening", 19, 19, 5, 9, {{9,9}, {10,10}, {9,10}, {8,9}, {10,8}}},
+};
+
+const int THREAD_COUNTS[] = {1, 2, 4, 8};
+
+}
+
+int main(int argc, char *argv[]) {
+    int extraDepth = 0;
+    int tableBits = 22;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--depth") && hasValue) {
+            extraDepth = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--table") && hasValue) {
+            tableBits = std::max(10, std::min(28, std::atoi(argv[++i])));
+        } else {
+            std::fprintf(stderr, "usage: %s [--depth D] [--table BITS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // На машине с меньшим числом ядер лишние потоки только делят время
+    std::printf("hardware threads: %u, table: 2^%d entries\n\n", std::thread::hardware_concurrency(), tableBits);
+
+    for (const BenchPosition& bench : POSITIONS) {
+        MnkPosition position(bench.rows, bench.cols, bench.k);
+        for (auto move : bench.moves)
+            position.play(move.first * bench.cols + move.second);
+        int depth = std::max(1, bench.depth + extraDepth);
+
+        std::printf("%s, depth %d\n", bench.name, depth);
+        std::printf("%8s %10s %12s %12s %6s %9s\n", "threads", "ms", "nodes", "nodes/s", "move", "speedup");
+        double baseline = 0;
+        for (int threads : THREAD_COUNTS) {
+            // Каждый замер с пустой таблицей, иначе следующий получит готовые оценки
+            MnkEngine engine(tableBits, threads);
+            auto start = Clock::now();
+            MnkEngine::Result result = engine.search(position, std::chrono::hours(1), depth);
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (threads == 1) baseline = seconds;
+            std::printf("%8d %10.1f %12llu %12.0f %6d %8.2fx\n", threads, seconds * 1000,
+                        static_cast<unsigned long long>(result.nodes), result.nodes / seconds,
+                        result.move, baseline / seconds);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
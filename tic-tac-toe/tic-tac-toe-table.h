@@ -0,0 +1,95 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Все позиции 3x3 решены при компиляции. Ключ позиции - число в троичной записи:
+// клетка row * 3 + col даёт цифру 0 (пусто), 1 (X) или 2 (O).
+// Оценка - для того, чей ход: 20 - число камней на доске при выигрыше
+// (быстрая победа лучше), со знаком минус при проигрыше, 0 - ничья
+namespace PerfectPlay {
+
+constexpr int CELLS = 9;
+constexpr int POSITIONS = 19683;  // 3^9
+constexpr int EMPTY = 0, X = 1, O = 2;
+
+constexpr int POW3[CELLS] = {1, 3, 9, 27, 81, 243, 729, 2187, 6561};
+
+// Линии как маски клеток
+constexpr std::uint16_t LINES[8] = {
+    0007, 0070, 0700,
+    0111, 0222, 0444,
+    0421, 0124
+};
+
+struct Entry {
+    std::int8_t score;
+    std::uint16_t bestMoves;  // маска клеток, дающих score
+};
+
+constexpr bool hasLine(int mask)
+{
+    for (std::uint16_t line : LINES)
+        if ((mask & line) == line)
+            return true;
+    return false;
+}
+
+// Ключи с большим числом камней больше, поэтому при обходе ключей по убыванию
+// все продолжения позиции уже решены. Решение укладывается в лимит вычислений
+// constexpr у GCC по умолчанию с большим запасом: пустые клетки перебираются по битам,
+// невозможные позиции пропускаются
+constexpr std::array<Entry, 2 * POSITIONS> solve()
+{
+    std::array<Entry, 2 * POSITIONS> table{};
+    for (int key = POSITIONS - 1; key >= 0; --key) {
+        int masks[3] = {0, 0, 0};
+        for (int cell = 0, rest = key; cell < CELLS; ++cell, rest /= 3)
+            masks[rest % 3] |= 1 << cell;
+        int stones = CELLS - __builtin_popcount(masks[EMPTY]);
+        int balance = __builtin_popcount(masks[X]) - __builtin_popcount(masks[O]);
+        bool lines[3] = {false, hasLine(masks[X]), hasLine(masks[O])};
+
+        for (int side = X; side <= O; ++side) {
+            int opponent = X + O - side;
+            Entry& entry = table[key * 2 + side - 1];
+            // У того, чей ход, камней столько же, сколько у соперника, или на один меньше,
+            // если начинал соперник: другие позиции в партии не встречаются и остаются пустыми
+            if (balance != 0 && balance != (side == X ? -1 : 1)) continue;
+            if (lines[opponent] || lines[side]) {
+                int score = 20 - stones;
+                entry = {static_cast<std::int8_t>(lines[opponent] ? -score : score), 0};
+                continue;
+            }
+            int best = -100;
+            std::uint16_t moves = 0;
+            for (int empty = masks[EMPTY]; empty; empty &= empty - 1) {
+                int cell = __builtin_ctz(empty);
+                int score = -table[(key + side * POW3[cell]) * 2 + opponent - 1].score;
+                if (score > best) {
+                    best = score;
+                    moves = 0;
+                }
+                if (score == best)
+                    moves |= 1 << cell;
+            }
+            entry = {static_cast<std::int8_t>(moves ? best : 0), moves};
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<Entry, 2 * POSITIONS> TABLE = solve();
+
+// side - X или O; для оконченной партии bestMoves пуст
+constexpr const Entry& lookup(int key, int side)
+{
+    return TABLE[key * 2 + side - 1];
+}
+
+static_assert(lookup(0, X).score == 0, "пустая доска - ничья");
+static_assert(lookup(0, X).bestMoves == 0777, "с пустой доски любой ход сохраняет ничью");
+// X на 0 и 1, O на 3 и 4: X выигрывает сразу, ходом в клетку 2
+static_assert(lookup(1 + 3 + 2 * 27 + 2 * 81, X).bestMoves == 1 << 2, "выигрыш в один ход");
+static_assert(lookup(1 + 3 + 9 + 2 * 27 + 2 * 81, O).bestMoves == 0, "оконченная позиция без ходов");
+
+}
@@ -6,14 +6,24 @@
 #include <QComboBox>
 #include <QMessageBox>
 #include <QVector>
+#include <thread>
+#include "tic-tac-toe-table.h"
+#include "mnk-engine.h"
+#include "ultimate-engine.h"
+#include "qubic-engine.h"
 
 enum class Player { None, X, O };
 
+// Mnk - доска rows x cols и winLength в ряд; Ultimate - 9x9 из малых досок;
+// Qubic - куб 4x4x4, слои показаны рядом на доске 4x16
+enum class Variant { Mnk, Ultimate, Qubic };
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
     MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
 private slots:
     void handleButton(int row, int col);
     void restartGame();
@@ -22,23 +32,49 @@ private slots:
     void aiMove();
     void onModeChanged(int);
     void onDifficultyChanged(int);
+    void onBoardChanged(int);
+    void updateBestMoves();
+    void updateUltimateBoards();
 
 private:
+    void buildBoard();
+    void placeMark(int row, int col);
     bool checkGameOver();
     bool isBoardFull();
     bool checkWin(Player p, QVector<QPair<int,int>>* winLine = nullptr);
+    bool checkUltimateWin(Player p, QVector<QPair<int,int>>* winLine);
+    bool checkQubicWin(Player p, QVector<QPair<int,int>>* winLine);
+    // Кнопка (row, col) - клетка позиции текущего варианта и обратно
+    int boardCell(int row, int col) const;
+    QPair<int,int> cellButton(int cell) const;
     void makeAIMoveRandom();
-    void makeAIMoveMinimax();
-    int minimax(Player current, int depth, int &bestRow, int &bestCol);
+    void makeAIMovePerfect();
+    void makeAIMoveEngine();
+    void stopEngine();
+    bool isClassic() const { return variant == Variant::Mnk && rows == 3 && cols == 3 && winLength == 3; }
+    int positionKey() const;
     Player startingPlayer;
     QVector<QVector<Player>> board;
     QVector<QVector<QPushButton*>> buttons;
     QLabel *statusLabel;
     QComboBox *modeCombo;
     QComboBox *difficultyCombo;
+    QComboBox *boardCombo;
+    QGridLayout *grid;
     QPushButton *restartBtn;
+    QPushButton *bestMovesBtn;
     QPushButton *menuButton;
     Player currentPlayer;
     bool vsAI;
     int aiDifficulty; // 0 - Easy, 1 - Hard
+    int rows, cols, winLength;
+    Variant variant;
+    MnkPosition position;  // та же партия, что и в board, для движка
+    MnkEngine engine;
+    UltimatePosition ultimatePosition;  // вместо position в режиме Ultimate
+    UltimateEngine ultimateEngine;
+    QubicPosition qubicPosition;  // вместо position в режиме Qubic
+    QubicEngine qubicEngine;
+    std::thread aiThread;
+    int aiGeneration;  // ход из устаревшего поиска (после рестарта) отбрасывается
 };
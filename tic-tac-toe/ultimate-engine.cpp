@@ -0,0 +1,265 @@
+#include "ultimate-engine.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace {
+
+constexpr std::uint16_t LINES[8] = {
+    0007, 0070, 0700,
+    0111, 0222, 0444,
+    0421, 0124
+};
+
+// WINNING[mask] - есть ли в маске из 9 клеток три в ряд
+constexpr std::array<bool, 512> makeWinning() {
+    std::array<bool, 512> result{};
+    for (int mask = 0; mask < 512; ++mask)
+        for (std::uint16_t line : LINES)
+            if ((mask & line) == line)
+                result[mask] = true;
+    return result;
+}
+
+constexpr std::array<bool, 512> WINNING = makeWinning();
+
+// Число клеток в маске и номер n-й из них: в случайной партии на каждый ход
+// приходится по выбору, цикл по битам и popcount без -mpopcnt заметно дороже таблиц
+struct MaskTables {
+    std::array<std::uint8_t, 512> count{};
+    std::array<std::array<std::uint8_t, 9>, 512> select{};
+};
+
+constexpr MaskTables makeMaskTables() {
+    MaskTables tables{};
+    for (int mask = 0; mask < 512; ++mask)
+        for (int cell = 0; cell < 9; ++cell)
+            if (mask >> cell & 1)
+                tables.select[mask][tables.count[mask]++] = static_cast<std::uint8_t>(cell);
+    return tables;
+}
+
+constexpr MaskTables MASKS = makeMaskTables();
+
+// Все деревья вместе, по 16 байт на узел; дальше листья не раскрываются,
+// а партии разыгрываются от них
+constexpr std::size_t NODE_BUDGET = std::size_t(1) << 23;
+constexpr int CHECK_INTERVAL = 256;  // итераций между проверками времени
+constexpr float EXPLORATION = 1.0f;
+
+// xorshift64*: партия - десятки случайных чисел, std::mt19937 здесь заметно дороже
+inline std::uint32_t nextRandom(std::uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<std::uint32_t>((state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+inline int randomBelow(std::uint64_t& state, int bound) {
+    return static_cast<int>((std::uint64_t(nextRandom(state)) * bound) >> 32);
+}
+
+}
+
+UltimatePosition::UltimatePosition(int first)
+    : marks{},
+      won{},
+      closed(0),
+      forced(-1),
+      side(static_cast<std::int8_t>(first)),
+      result(EMPTY) {
+}
+
+int UltimatePosition::at(int cell) const {
+    int board = cell / 9, bit = 1 << (cell % 9);
+    if (marks[0][board] & bit) return X;
+    if (marks[1][board] & bit) return O;
+    return EMPTY;
+}
+
+int UltimatePosition::boardWinner(int board) const {
+    if (won[0] >> board & 1) return X;
+    if (won[1] >> board & 1) return O;
+    return EMPTY;
+}
+
+bool UltimatePosition::isLegal(int cell) const {
+    if (cell < 0 || cell >= CELLS || over()) return false;
+    int board = cell / 9;
+    if (forced >= 0 && board != forced) return false;
+    return legalMask(board) >> (cell % 9) & 1;
+}
+
+int UltimatePosition::legalMoves(int* moves) const {
+    int count = 0;
+    if (over()) return 0;
+    for (int board = 0; board < 9; ++board) {
+        if (forced >= 0 && board != forced) continue;
+        std::uint16_t mask = legalMask(board);
+        for (int i = 0; i < MASKS.count[mask]; ++i)
+            moves[count++] = board * 9 + MASKS.select[mask][i];
+    }
+    return count;
+}
+
+void UltimatePosition::play(int cell) {
+    int board = cell / 9, inner = cell % 9;
+    int player = side - 1;
+    std::uint16_t& mine = marks[player][board];
+    mine |= 1 << inner;
+    if (WINNING[mine]) {
+        won[player] |= 1 << board;
+        closed |= 1 << board;
+        if (WINNING[won[player]]) result = side;
+    } else if ((mine | marks[player ^ 1][board]) == FULL) {
+        closed |= 1 << board;
+    }
+    forced = static_cast<std::int8_t>((closed >> inner & 1) ? -1 : inner);
+    side = static_cast<std::int8_t>(X + O - side);
+}
+
+UltimateEngine::UltimateEngine(int threads)
+    : stopRequested(false) {
+    setThreads(threads);
+}
+
+void UltimateEngine::setThreads(int count) {
+    workers.resize(std::max(1, std::min(count, MAX_THREADS)));
+}
+
+int UltimateEngine::playout(UltimatePosition& position, std::uint64_t& rng) {
+    while (!position.over()) {
+        int board = position.forcedBoard();
+        std::uint16_t mask;
+        int pick;
+        if (board >= 0) {
+            mask = position.legalMask(board);
+            pick = randomBelow(rng, MASKS.count[mask]);
+        } else {
+            // Доска выбирается по числу пустых клеток, чтобы все ходы были равновероятны
+            int counts[9], total = 0;
+            for (int b = 0; b < 9; ++b) {
+                counts[b] = MASKS.count[position.legalMask(b)];
+                total += counts[b];
+            }
+            pick = randomBelow(rng, total);
+            for (board = 0; pick >= counts[board]; ++board)
+                pick -= counts[board];
+            mask = position.legalMask(board);
+        }
+        position.play(board * 9 + MASKS.select[mask][pick]);
+    }
+    return position.winner();
+}
+
+void UltimateEngine::iterate(Worker& worker, const UltimatePosition& root) {
+    std::vector<Node>& nodes = worker.nodes;
+    UltimatePosition position = root;
+    worker.path.clear();
+    worker.path.push_back(0);
+    std::int32_t current = 0;
+
+    while (nodes[current].firstChild >= 0 && !position.over()) {
+        const Node& parent = nodes[current];
+        float logVisits = std::log(static_cast<float>(parent.visits));
+        std::int32_t best = parent.firstChild;
+        float bestValue = -1;
+        for (std::int32_t child = parent.firstChild; child < parent.firstChild + parent.childCount; ++child) {
+            const Node& node = nodes[child];
+            if (node.visits == 0) {
+                best = child;
+                break;
+            }
+            float value = node.score / node.visits + EXPLORATION * std::sqrt(logVisits / node.visits);
+            if (value > bestValue) {
+                bestValue = value;
+                best = child;
+            }
+        }
+        current = best;
+        position.play(nodes[current].move);
+        worker.path.push_back(current);
+    }
+
+    // Лист раскрывается при втором посещении: после одной партии узлы не заводятся
+    if (!position.over() && nodes[current].visits > 0 &&
+        nodes.size() + UltimatePosition::CELLS <= nodes.capacity()) {
+        int moves[UltimatePosition::CELLS];
+        int count = position.legalMoves(moves);
+        std::int32_t first = static_cast<std::int32_t>(nodes.size());
+        nodes[current].firstChild = first;
+        nodes[current].childCount = static_cast<std::uint8_t>(count);
+        for (int i = 0; i < count; ++i) {
+            Node child;
+            child.move = static_cast<std::uint8_t>(moves[i]);
+            nodes.push_back(child);
+        }
+        current = first + randomBelow(worker.rng, count);
+        position.play(nodes[current].move);
+        worker.path.push_back(current);
+    }
+
+    int winner = position.over() ? position.winner() : playout(position, worker.rng);
+    worker.playouts++;
+
+    // В корень ходил соперник того, кто ходит из корня
+    int mover = UltimatePosition::X + UltimatePosition::O - root.sideToMove();
+    for (std::int32_t index : worker.path) {
+        Node& node = nodes[index];
+        node.visits++;
+        node.score += winner == mover ? 1.0f : (winner == UltimatePosition::EMPTY ? 0.5f : 0.0f);
+        mover = UltimatePosition::X + UltimatePosition::O - mover;
+    }
+}
+
+void UltimateEngine::run(Worker& worker, const UltimatePosition& root, std::chrono::steady_clock::time_point deadline) {
+    while (!stopRequested) {
+        for (int i = 0; i < CHECK_INTERVAL; ++i)
+            iterate(worker, root);
+        if (std::chrono::steady_clock::now() >= deadline) break;
+    }
+}
+
+UltimateEngine::Result UltimateEngine::search(const UltimatePosition& root, std::chrono::milliseconds limit) {
+    auto deadline = std::chrono::steady_clock::now() + limit;
+    Result result;
+    int moves[UltimatePosition::CELLS];
+    int count = root.legalMoves(moves);
+    if (count == 0) return result;
+    result.move = moves[0];
+
+    std::uint64_t seed = std::random_device{}();
+    std::size_t capacity = NODE_BUDGET / workers.size();
+    for (std::size_t i = 0; i < workers.size(); ++i) {
+        Worker& worker = workers[i];
+        worker.nodes.clear();
+        worker.nodes.reserve(capacity);
+        worker.nodes.push_back(Node());
+        worker.rng = (seed + i + 1) * 0x9E3779B97F4A7C15ULL | 1;
+        worker.playouts = 0;
+    }
+
+    std::vector<std::thread> helpers;
+    for (std::size_t i = 1; i < workers.size(); ++i)
+        helpers.emplace_back([this, &root, i, deadline] { run(workers[i], root, deadline); });
+    run(workers[0], root, deadline);
+    for (std::thread& helper : helpers) helper.join();
+
+    // Ход выбирается по сумме посещений: она устойчивее средней оценки
+    std::array<std::uint64_t, UltimatePosition::CELLS> visits{};
+    std::array<double, UltimatePosition::CELLS> scores{};
+    for (const Worker& worker : workers) {
+        result.playouts += worker.playouts;
+        const Node& top = worker.nodes[0];
+        for (std::int32_t child = top.firstChild; top.firstChild >= 0 && child < top.firstChild + top.childCount; ++child) {
+            visits[worker.nodes[child].move] += worker.nodes[child].visits;
+            scores[worker.nodes[child].move] += worker.nodes[child].score;
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        if (visits[moves[i]] > visits[result.move]) result.move = moves[i];
+    }
+    if (visits[result.move] > 0) result.winRate = scores[result.move] / visits[result.move];
+    return result;
+}
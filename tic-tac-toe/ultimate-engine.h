@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Ultimate: 9 досок 3x3 в большой доске 3x3. Клетка cell = board * 9 + inner,
+// обе части нумеруются по строкам. Ход в клетку inner отправляет соперника
+// на доску inner; если она уже выиграна или заполнена - ход в любую открытую.
+// Каждая доска - по 9-битной маске на игрока
+class UltimatePosition {
+public:
+    static constexpr int CELLS = 81;
+    static constexpr int EMPTY = 0, X = 1, O = 2;
+    static constexpr std::uint16_t FULL = 0x1FF;
+
+    explicit UltimatePosition(int first = X);
+
+    int at(int cell) const;
+    int sideToMove() const { return side; }
+    // Доска, на которой обязан быть ход; -1 - любая открытая
+    int forcedBoard() const { return forced; }
+    // X или O для выигранной доски, EMPTY для открытой или ничейной
+    int boardWinner(int board) const;
+    bool boardClosed(int board) const { return closed >> board & 1; }
+    int winner() const { return result; }
+    bool over() const { return result != EMPTY || closed == FULL; }
+
+    bool isLegal(int cell) const;
+    // Пустые клетки доски, 0 для закрытой; forcedBoard() здесь не учитывается
+    std::uint16_t legalMask(int board) const {
+        return boardClosed(board) ? 0 : FULL & ~(marks[0][board] | marks[1][board]);
+    }
+    // Возвращает число ходов, moves вмещает CELLS
+    int legalMoves(int* moves) const;
+    void play(int cell);
+
+private:
+    std::array<std::array<std::uint16_t, 9>, 2> marks;  // [игрок - 1][доска]
+    std::array<std::uint16_t, 2> won;  // выигранные доски как клетки большой доски
+    std::uint16_t closed;              // выигранные и заполненные доски
+    std::int8_t forced;
+    std::int8_t side;
+    std::int8_t result;
+};
+
+// Поиск по дереву Монте-Карло (UCT). Каждый поток растит своё дерево из того же
+// корня со своими случайными партиями, в конце посещения ходов корня складываются
+class UltimateEngine {
+public:
+    static constexpr int MAX_THREADS = 64;
+
+    struct Result {
+        int move = -1;
+        double winRate = 0;  // доля побед хода для того, кто его делает; ничья - половина
+        std::uint64_t playouts = 0;
+    };
+
+    explicit UltimateEngine(int threads = 1);
+
+    Result search(const UltimatePosition& root, std::chrono::milliseconds limit);
+    // Можно вызвать из другого потока, search() вернётся после ближайшей проверки.
+    // Запрос действует и на search(), который ещё не начался, и держится до resume()
+    void stop() { stopRequested = true; }
+    // Вызывать до запуска потока с search(), а не внутри него
+    void resume() { stopRequested = false; }
+    // Не вызывать во время search()
+    void setThreads(int count);
+    int threads() const { return static_cast<int>(workers.size()); }
+
+private:
+    struct Node {
+        std::int32_t firstChild = -1;  // дети лежат подряд; -1 - не раскрыт
+        std::uint8_t childCount = 0;
+        std::uint8_t move = 0;         // ход, который привёл в узел
+        std::uint32_t visits = 0;
+        float score = 0;               // для того, кто сделал move
+    };
+
+    struct Worker {
+        std::vector<Node> nodes;
+        std::vector<std::int32_t> path;
+        std::uint64_t rng = 0;
+        std::uint64_t playouts = 0;
+    };
+
+    std::vector<Worker> workers;
+    std::atomic<bool> stopRequested;
+
+    void run(Worker& worker, const UltimatePosition& root, std::chrono::steady_clock::time_point deadline);
+    void iterate(Worker& worker, const UltimatePosition& root);
+    static int playout(UltimatePosition& position, std::uint64_t& rng);
+};